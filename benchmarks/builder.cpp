@@ -0,0 +1,63 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+
+#include <string>
+
+#include "model/builder.h"
+
+namespace {
+
+using namespace sismicpp::builder;
+
+// A complete tree of compound states with a fan-out of 4, and a transition on every state.
+template <int Depth>
+struct Tree {
+    static auto make(const std::string& prefix) {
+        return state(
+            name(prefix),
+            initial(prefix + "0"),
+            transition(event("reset"), target(prefix + "0")),
+            Tree<Depth - 1>::make(prefix + "0"),
+            Tree<Depth - 1>::make(prefix + "1"),
+            Tree<Depth - 1>::make(prefix + "2"),
+            Tree<Depth - 1>::make(prefix + "3")
+        );
+    }
+};
+
+template <>
+struct Tree<0> {
+    static auto make(const std::string& prefix) {
+        return state(name(prefix), transition(event("tick"), target(prefix)));
+    }
+};
+
+sismicpp::StateChart make_statechart() {
+    return build_statechart(
+        name("Tree"),
+        description("5461 states"),
+        root_state(
+            name("root"),
+            initial("0"),
+            Tree<5>::make("0"),
+            Tree<5>::make("1"),
+            Tree<5>::make("2"),
+            Tree<5>::make("3")
+        )
+    );
+}
+
+}  // namespace
+
+TEST_CASE( "Builder DSL", "[sismicpp][benchmark]" ) {
+    REQUIRE( make_statechart().states.size() == 5461 );
+
+    BENCHMARK( "Build a statechart of 5461 states" ) {
+        return make_statechart();
+    };
+
+    BENCHMARK( "Write the DSL expression only" ) {
+        return Tree<5>::make("0");
+    };
+}
@@ -0,0 +1,83 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <string>
+
+#include "interpreter/default.h"
+
+namespace {
+
+const size_t steps = 100000;
+
+// Every hit sends another one, so that each macro step allocates external, internal and meta-events.
+sismicpp::StateChart make_statechart() {
+    using namespace sismicpp;
+
+    StateChart statechart{"Events"};
+    statechart.add_state(CompoundState("root", "ping"), "");
+    statechart.add_state(BasicState("ping"), "root");
+    statechart.add_state(BasicState("pong"), "root");
+    statechart.add_transition({
+        .source="ping",
+        .target="pong",
+        .event="hit",
+        .action=[] (auto, ActionContext& action_context) { action_context.send(Event("hit")); }
+    });
+    statechart.add_transition({.source="pong", .target="ping", .event="hit"});
+    return statechart;
+}
+
+struct Counter : sismicpp::Attachable {
+    size_t count = 0;
+
+    void operator()(std::shared_ptr<const sismicpp::MetaEvent>) override {
+        ++count;
+    }
+};
+
+}  // namespace
+
+TEST_CASE( "Event allocation", "[sismicpp][benchmark]" ) {
+    using namespace sismicpp;
+
+    auto compiled = std::make_shared<const CompiledStateChart>(make_statechart());
+
+    BENCHMARK( "Step 100k sending macro steps" ) {
+        Interpreter interpreter{compiled, nullptr};
+        Counter counter;
+        interpreter.attach(&counter);
+        interpreter.execute();
+        for (size_t i = 0; i < steps; ++i) {
+            interpreter.queue("hit").execute_once();
+            interpreter.execute_once();
+        }
+        return counter.count;
+    };
+
+    BENCHMARK( "Step 100k sending macro steps into a reused macro step" ) {
+        Interpreter interpreter{compiled, nullptr};
+        Counter counter;
+        interpreter.attach(&counter);
+        interpreter.execute();
+        MacroStep macro_step;
+        for (size_t i = 0; i < steps; ++i) {
+            interpreter.queue("hit").execute_once(macro_step);
+            interpreter.execute_once(macro_step);
+        }
+        return counter.count;
+    };
+
+    BENCHMARK( "Step 100k sending macro steps discarding the steps" ) {
+        Interpreter interpreter{compiled, nullptr};
+        Counter counter;
+        interpreter.attach(&counter);
+        interpreter.execute();
+        for (size_t i = 0; i < steps; ++i) {
+            interpreter.queue("hit").execute_once(discard_steps);
+            interpreter.execute_once(discard_steps);
+        }
+        return counter.count;
+    };
+}
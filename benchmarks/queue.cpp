@@ -0,0 +1,112 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "interpreter/default.h"
+
+namespace {
+
+const size_t pending = 100000;
+
+sismicpp::StateChart make_statechart() {
+    using namespace sismicpp;
+
+    StateChart statechart{"Queue"};
+    statechart.add_state(CompoundState("root", "0"), "");
+    statechart.add_state(BasicState("0"), "root");
+    statechart.add_transition({.source="0", .event="tick"});
+    return statechart;
+}
+
+// Delays spread over [0, 1000) in a scrambled order, so that most events are not queued last.
+std::vector<std::shared_ptr<const sismicpp::Event>> make_events() {
+    std::vector<std::shared_ptr<const sismicpp::Event>> ret;
+    ret.reserve(pending);
+    for (size_t i = 0; i < pending; ++i) {
+        auto event = std::make_shared<sismicpp::Event>("tick");
+        event->delay = static_cast<double>((i * 7919) % pending) / 100;
+        ret.push_back(std::move(event));
+    }
+    return ret;
+}
+
+}  // namespace
+
+TEST_CASE( "Event queues", "[sismicpp][benchmark]" ) {
+    using namespace sismicpp;
+
+    auto compiled = std::make_shared<const CompiledStateChart>(make_statechart());
+    auto events = make_events();
+
+    BENCHMARK_ADVANCED( "Queue 100k delayed events" )(Catch::Benchmark::Chronometer meter) {
+        std::vector<std::unique_ptr<Interpreter>> interpreters;
+        for (int i = 0; i < meter.runs(); ++i) {
+            interpreters.push_back(std::make_unique<Interpreter>(compiled, nullptr));
+        }
+        meter.measure([&] (int run) {
+            for (auto&& event : events) {
+                interpreters[run]->queue(event);
+            }
+        });
+    };
+
+    BENCHMARK_ADVANCED( "Consume 100k delayed events" )(Catch::Benchmark::Chronometer meter) {
+        std::vector<std::unique_ptr<Interpreter>> interpreters;
+        for (int i = 0; i < meter.runs(); ++i) {
+            interpreters.push_back(std::make_unique<Interpreter>(compiled, nullptr));
+            interpreters.back()->execute();
+            for (auto&& event : events) {
+                interpreters.back()->queue(event);
+            }
+            static_cast<SimulatedClock&>(*interpreters.back()->clock).set_time(1000);
+        }
+        meter.measure([&] (int run) {
+            return interpreters[run]->execute().size();
+        });
+    };
+
+    BENCHMARK_ADVANCED( "Schedule and cancel 100k delayed events" )(Catch::Benchmark::Chronometer meter) {
+        std::vector<std::unique_ptr<Interpreter>> interpreters;
+        for (int i = 0; i < meter.runs(); ++i) {
+            interpreters.push_back(std::make_unique<Interpreter>(compiled, nullptr));
+            interpreters.back()->execute();
+        }
+        meter.measure([&] (int run) {
+            auto& interpreter = *interpreters[run];
+            for (auto&& event : events) {
+                interpreter.schedule(event).cancel();
+            }
+            static_cast<SimulatedClock&>(*interpreter.clock).set_time(1000);
+            return interpreter.execute().size();
+        });
+    };
+
+    BENCHMARK_ADVANCED( "Queue 100k delayed events in a batch" )(Catch::Benchmark::Chronometer meter) {
+        std::vector<std::unique_ptr<Interpreter>> interpreters;
+        for (int i = 0; i < meter.runs(); ++i) {
+            interpreters.push_back(std::make_unique<Interpreter>(compiled, nullptr));
+        }
+        meter.measure([&] (int run) {
+            interpreters[run]->queue_many(events);
+        });
+    };
+
+    BENCHMARK( "Queue and consume 100k undelayed events" ) {
+        Interpreter interpreter{compiled, nullptr};
+        interpreter.execute();
+        for (size_t i = 0; i < pending; ++i) {
+            interpreter.queue("tick");
+        }
+        return interpreter.execute().size();
+    };
+
+    BENCHMARK( "Execute a batch of 100k undelayed events" ) {
+        Interpreter interpreter{compiled, nullptr};
+        interpreter.execute();
+        return interpreter.execute_batch(std::vector<std::string>(pending, "tick")).consumed_events;
+    };
+}
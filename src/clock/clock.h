@@ -1,3 +1,4 @@
+#include <chrono>
 #include <stdexcept>
 #include <string>
 
@@ -8,9 +9,30 @@ namespace sismicpp {
 
 struct Clock {
     virtual double get_time() const = 0;
+
+    // Called by the interpreter around each macro step, so that a clock may read the time once per step.
+    virtual void start_step() {}
+    virtual void end_step() {}
+
     virtual ~Clock() {}
 };
 
+// Brackets a macro step, even if it throws.
+struct ClockStep {
+    Clock& clock;
+
+    explicit ClockStep(Clock& clock) : clock(clock) {
+        clock.start_step();
+    }
+
+    ClockStep(const ClockStep&) = delete;
+    ClockStep& operator=(const ClockStep&) = delete;
+
+    ~ClockStep() {
+        clock.end_step();
+    }
+};
+
 struct SimulatedClock : Clock {
     double time = 0;
 
@@ -30,6 +52,37 @@ struct SimulatedClock : Clock {
     }
 };
 
+// Seconds of the monotonic clock since the clock was created. The time is read once when a macro step starts,
+// and kept until it ends, so that the whole step sees a single time without reading the clock at every
+// comparison; between steps, each call reads the clock.
+struct SteadyClock : Clock {
+    using clock_type = std::chrono::steady_clock;
+
+    SteadyClock() : start(clock_type::now()) {}
+
+    double get_time() const override {
+        return in_step ? step_time : now();
+    }
+
+    void start_step() override {
+        step_time = now();
+        in_step = true;
+    }
+
+    void end_step() override {
+        in_step = false;
+    }
+
+private:
+    clock_type::time_point start;
+    double step_time = 0;
+    bool in_step = false;
+
+    double now() const {
+        return std::chrono::duration<double>(clock_type::now() - start).count();
+    }
+};
+
 }
 
 #endif  // INCLUDE
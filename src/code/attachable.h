@@ -2,21 +2,76 @@
 #define INCLUDE_SISMICPP_CODE_ATTACHABLE
 
 #include "model/events.h"
+#include <algorithm>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace sismicpp {
 
 struct Attachable {
     virtual void operator()(std::shared_ptr<const MetaEvent> event) = 0;
+
+    // Kinds of meta-events the listener receives, read when it is attached.
+    virtual MetaEventMask get_subscriptions() const {
+        return all_meta_events;
+    }
+
     virtual ~Attachable() {}
 };
 
+// Attached listeners, with the union of their subscriptions so that meta-events nobody receives are never built.
+struct ListenerSet {
+private:
+    struct Entry {
+        Attachable* listener;
+        MetaEventMask subscriptions;
+    };
+
+    std::vector<Entry> entries = {};
+    MetaEventMask subscriptions = 0;
+
+public:
+    void attach(Attachable* listener) {
+        entries.push_back({listener, listener->get_subscriptions()});
+        subscriptions |= entries.back().subscriptions;
+    }
+
+    void detach(Attachable* listener) {
+        entries.erase(std::find_if(entries.begin(), entries.end(), [listener] (const Entry& entry) {
+            return entry.listener == listener;
+        }));
+        subscriptions = 0;
+        for (auto&& entry : entries) {
+            subscriptions |= entry.subscriptions;
+        }
+    }
+
+    bool wants(MetaEventKind kind) const {
+        return (subscriptions & mask_for(kind)) != 0;
+    }
+
+    void notify(const std::shared_ptr<const MetaEvent>& event) const {
+        auto mask = mask_for(event->kind);
+        for (auto&& entry : entries) {
+            if (entry.subscriptions & mask) {
+                entry.listener->operator()(event);
+            }
+        }
+    }
+};
+
 struct Observable {
     virtual void attach(Attachable* listener) = 0;
     virtual void detach(Attachable* listener) = 0;
     virtual ~Observable() {}
 };
 
+struct ActiveStatesProvider {
+    virtual bool is_active(const std::string& name) const = 0;
+    virtual ~ActiveStatesProvider() {}
+};
+
 }  // namespace sismicpp
 
 #endif  // INCLUDE
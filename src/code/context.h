@@ -16,7 +16,14 @@ struct TimeContextProvider : Attachable {
     std::map<std::string, double> entry_time = {};
     std::map<std::string, double> idle_time = {};
     double time = 0;
-    std::vector<std::string> configuration = {};
+    // Narrowed by the evaluators: entry and idle times are only needed by the after() and idle() of guards,
+    // and the time of the step by the code run in a context.
+    MetaEventMask subscriptions = mask_for(MetaEventKind::step_started) | mask_for(MetaEventKind::state_entered) |
+                                  mask_for(MetaEventKind::transition_processed);
+
+    MetaEventMask get_subscriptions() const override {
+        return subscriptions;
+    }
 
     bool after(const std::string& name, double seconds) const {
         return time - seconds >= entry_time.at(name);
@@ -26,21 +33,20 @@ struct TimeContextProvider : Attachable {
         return time - seconds >= idle_time.at(name);
     }
 
-    bool active(const std::string& name) {
-        return std::find(configuration.begin(), configuration.end(), name) != configuration.end();
-    }
-
     void operator()(std::shared_ptr<const MetaEvent> event) override {
-        if (event->name == "step started") {
-            time = event->time;
-        } else if (event->name == "state entered") {
-            configuration.push_back(event->state);
-            entry_time[event->state] = time;
-            idle_time[event->state] = time;
-        } else if (event->name == "state exited") {
-            configuration.erase(std::find(configuration.begin(), configuration.end(), event->state));
-        } else if (event->name == "transition processed") {
-            idle_time[event->source] = time;
+        switch (event->kind) {
+            case MetaEventKind::step_started:
+                time = event->time;
+                break;
+            case MetaEventKind::state_entered:
+                entry_time[event->get_state()] = time;
+                idle_time[event->get_state()] = time;
+                break;
+            case MetaEventKind::transition_processed:
+                idle_time[event->get_source()] = time;
+                break;
+            default:
+                break;
         }
     }
 };
@@ -70,15 +76,26 @@ struct EventContextProvider : Attachable {
         return consumed and consumed->name == name;
     }
 
+    MetaEventMask get_subscriptions() const override {
+        return mask_for(MetaEventKind::event_consumed) | mask_for(MetaEventKind::event_sent) |
+               mask_for(MetaEventKind::step_started);
+    }
+
     void operator()(std::shared_ptr<const MetaEvent> event) override {
-        if (event->name == "event consumed") {
-            consumed = event->event;
-        } else if (event->name == "event sent") {
-            sent.push_back(event->event);
-        } else if (event->name == "step started") {
-            consumed = nullptr;
-            sent.clear();
-            pending.clear();
+        switch (event->kind) {
+            case MetaEventKind::event_consumed:
+                consumed = event->event;
+                break;
+            case MetaEventKind::event_sent:
+                sent.push_back(event->event);
+                break;
+            case MetaEventKind::step_started:
+                consumed = nullptr;
+                sent.clear();
+                pending.clear();
+                break;
+            default:
+                break;
         }
     }
 };
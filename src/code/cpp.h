@@ -10,135 +10,198 @@
 
 namespace sismicpp {
 
+struct CppGuardContext : GuardContext {
+    bool active(const std::string& name) const override {
+        return active_states.is_active(name);
+    }
+
+    double get_time() const override {
+        return time_provider.time;
+    }
+
+    bool after(double seconds) const override {
+        return time_provider.after(source, seconds);
+    }
+
+    bool idle(double seconds) const override {
+        return time_provider.idle(source, seconds);
+    }
+
+    Event const* get_event() const override {
+        return event;
+    }
+
+    CppGuardContext(const TimeContextProvider& time_provider, const ActiveStatesProvider& active_states,
+                    const std::string& source, const Event* event) :
+    time_provider(time_provider),
+    active_states(active_states),
+    source(source),
+    event(event) {}
+private:
+    const TimeContextProvider& time_provider;
+    const ActiveStatesProvider& active_states;
+    const std::string& source;
+    const Event* event;
+};
+
+struct CppActionContext : ActionContext {
+    bool active(const std::string& name) const override {
+        return active_states.is_active(name);
+    }
+
+    double get_time() const override {
+        return time_provider.time;
+    }
+
+    EventHandle send(Event event) override {
+        auto internal_event = make_pooled<InternalEvent>(event_pool, std::move(event));
+        internal_event->handle = EventHandle::create(event_pool);
+        ret.push_back(internal_event);
+        return internal_event->handle;
+    }
+
+    void notify(Event event) override {
+        ret.emplace_back(make_pooled<MetaEvent>(event_pool, std::move(event)));
+    }
+
+    std::shared_ptr<const Event> get_event() const override {
+        return event;
+    }
+
+    CppActionContext(const TimeContextProvider& time_provider,
+                     const ActiveStatesProvider& active_states,
+                     std::shared_ptr<const Event> event,
+                     std::vector<std::shared_ptr<const Event>>& ret,
+                     EventPool* event_pool = nullptr) :
+    time_provider(time_provider),
+    active_states(active_states),
+    event(event),
+    ret(ret),
+    event_pool(event_pool) {}
+private:
+    const TimeContextProvider& time_provider;
+    const ActiveStatesProvider& active_states;
+    std::shared_ptr<const Event> event;
+    std::vector<std::shared_ptr<const Event>>& ret;
+    EventPool* event_pool;
+};
+
+struct CppOnEntryExitContext : OnEntryExitContext {
+    bool active(const std::string& name) const override {
+        return active_states.is_active(name);
+    }
+
+    double get_time() const override {
+        return time_provider.time;
+    }
+
+    EventHandle send(Event event) override {
+        auto internal_event = make_pooled<InternalEvent>(event_pool, std::move(event));
+        internal_event->handle = EventHandle::create(event_pool);
+        ret.push_back(internal_event);
+        return internal_event->handle;
+    }
+
+    void notify(Event event) override {
+        ret.emplace_back(make_pooled<MetaEvent>(event_pool, std::move(event)));
+    }
+
+    CppOnEntryExitContext(const TimeContextProvider& time_provider,
+                          const ActiveStatesProvider& active_states,
+                          std::vector<std::shared_ptr<const Event>>& ret,
+                          EventPool* event_pool = nullptr) :
+    time_provider(time_provider),
+    active_states(active_states),
+    ret(ret),
+    event_pool(event_pool) {}
+private:
+    const TimeContextProvider& time_provider;
+    const ActiveStatesProvider& active_states;
+    std::vector<std::shared_ptr<const Event>>& ret;
+    EventPool* event_pool;
+};
+
 struct CppEvaluator : Evaluator {
     void* context = nullptr;
     TimeContextProvider time_provider = {};
+    const ActiveStatesProvider& active_states;
+    // Sent events are allocated from the pool if there is one.
+    EventPool* event_pool = nullptr;
 
-    CppEvaluator(Observable& interpreter, void* context) :
+    CppEvaluator(Observable& interpreter, const ActiveStatesProvider& active_states, void* context,
+                 EventPool* event_pool = nullptr) :
     context(context),
-    time_provider{} {
+    time_provider{},
+    active_states(active_states),
+    event_pool(event_pool),
+    interpreter(interpreter) {
         interpreter.attach(&time_provider);
     }
 
+    ~CppEvaluator() override {
+        interpreter.detach(&time_provider);
+    }
+
     void* get_context() override {
         return context;
     };
 
     void execute_statechart(const StateChart& statechart) override {
+        auto has_guards = false;
+        auto has_code = false;
+        for (auto&& transition : statechart.transitions) {
+            has_guards = has_guards or transition.guard;
+            has_code = has_code or transition.guard or transition.action;
+        }
+        for (auto&& state : statechart.states) {
+            has_code = has_code or state.second->on_entry or state.second->on_exit;
+        }
+
+        auto subscriptions = time_provider.subscriptions;
+        if (!has_guards) {
+            subscriptions &= mask_for(MetaEventKind::step_started);
+        }
+        if (!has_code) {
+            subscriptions = 0;
+        }
+        if (subscriptions != time_provider.subscriptions) {
+            interpreter.detach(&time_provider);
+            time_provider.subscriptions = subscriptions;
+            interpreter.attach(&time_provider);
+        }
+
         if (statechart.preamble) {
             statechart.preamble(context);
         }
     };
 
     bool evaluate_guard(const Transition& transition, const Event* event) const override {
-        struct MyGuardContext : GuardContext {
-            bool active(const std::string& name) const override {
-                return std::find(time_provider.configuration.begin(), time_provider.configuration.end(), name) != time_provider.configuration.end();
-            }
-
-            double get_time() const override {
-                return time_provider.time;
-            }
-
-            bool after(double seconds) const override {
-                return time_provider.after(source, seconds);
-            }
-
-            bool idle(double seconds) const override {
-                return time_provider.idle(source, seconds);
-            }
-
-            Event const* get_event() const override {
-                return event;
-            }
-
-            MyGuardContext(const TimeContextProvider& time_provider, const std::string& source, const Event* event) :
-            time_provider(time_provider), 
-            source(source),
-            event(event) {}
-        private:
-            const TimeContextProvider& time_provider;
-            const std::string& source;
-            const Event* event;
-        } guard_context(time_provider, transition.source, event);
-
+        CppGuardContext guard_context(time_provider, active_states, transition.source, event);
         return transition.guard(context, guard_context);
     };
 
     std::vector<std::shared_ptr<const Event>> execute_action(const Transition& transition, std::shared_ptr<const Event> event) const override {
         std::vector<std::shared_ptr<const Event>> ret;
-
-        struct MyActionContext : ActionContext {
-            bool active(const std::string& name) const override {
-                return std::find(time_provider.configuration.begin(), time_provider.configuration.end(), name) != time_provider.configuration.end();
-            }
-
-            double get_time() const override {
-                return time_provider.time;
-            }
-
-            void send(Event event) override {
-                ret.push_back(std::make_shared<InternalEvent>(std::move(event)));
-            }
-
-            void notify(Event event) override {
-                ret.emplace_back(std::make_shared<MetaEvent>(std::move(event)));
-            }
-
-            std::shared_ptr<const Event> get_event() const override {
-                return event;
-            }
-
-            MyActionContext(const TimeContextProvider& time_provider,
-                            std::shared_ptr<const Event> event,
-                            std::vector<std::shared_ptr<const Event>>& ret) :
-            time_provider(time_provider), 
-            event(event),
-            ret(ret) {}
-        private:
-            const TimeContextProvider& time_provider;
-            std::shared_ptr<const Event> event;
-            std::vector<std::shared_ptr<const Event>>& ret;
-        } action_context(time_provider, event, ret);
-
-        transition.action(context, action_context);
-
+        execute_action_into(transition, std::move(event), ret);
         return ret;
     };
 
-    std::vector<std::shared_ptr<const Event>> execute_on_entryexit(on_entryexit_func func) const {
+    std::vector<std::shared_ptr<const Event>> execute_on_entryexit(on_entryexit_func func) const override {
         std::vector<std::shared_ptr<const Event>> ret;
+        execute_on_entryexit_into(func, ret);
+        return ret;
+    };
 
-        struct MyOnEntryExitContext : OnEntryExitContext {
-            bool active(const std::string& name) const override {
-                return std::find(time_provider.configuration.begin(), time_provider.configuration.end(), name) != time_provider.configuration.end();
-            }
-
-            double get_time() const override {
-                return time_provider.time;
-            }
-
-            void send(Event event) override {
-                ret.emplace_back(std::make_shared<InternalEvent>(std::move(event)));
-            }
-
-            void notify(Event event) override {
-                ret.emplace_back(std::make_shared<MetaEvent>(std::move(event)));
-            }
-
-            MyOnEntryExitContext(const TimeContextProvider& time_provider,
-                            std::vector<std::shared_ptr<const Event>>& ret) :
-            time_provider(time_provider), 
-            ret(ret) {}
-        private:
-            const TimeContextProvider& time_provider;
-            std::vector<std::shared_ptr<const Event>>& ret;
-        } on_entryexit_context(time_provider, ret);
+    void execute_action_into(const Transition& transition, std::shared_ptr<const Event> event,
+                             std::vector<std::shared_ptr<const Event>>& sent_events) const override {
+        CppActionContext action_context(time_provider, active_states, std::move(event), sent_events, event_pool);
+        transition.action(context, action_context);
+    }
 
+    void execute_on_entryexit_into(on_entryexit_func func, std::vector<std::shared_ptr<const Event>>& sent_events) const override {
+        CppOnEntryExitContext on_entryexit_context(time_provider, active_states, sent_events, event_pool);
         func(context, on_entryexit_context);
-
-        return ret;
-    };
+    }
 
     std::vector<std::shared_ptr<const Event>> execute_on_entry(const State& state) const override {
         return execute_on_entryexit(state.on_entry);
@@ -147,6 +210,9 @@ struct CppEvaluator : Evaluator {
     std::vector<std::shared_ptr<const Event>> execute_on_exit(const State& state) const override {
         return execute_on_entryexit(state.on_exit);
     };
+
+private:
+    Observable& interpreter;
 };
 
 }  // namespace sismicpp
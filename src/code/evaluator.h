@@ -5,6 +5,8 @@
 #include "model/elements.h"
 #include "model/statechart.h"
 
+#include <algorithm>
+#include <iterator>
 #include <string>
 #include <vector>
 #include <memory>
@@ -18,6 +20,20 @@ struct Evaluator {
     virtual std::vector<std::shared_ptr<const Event>> execute_action(const Transition& transition, std::shared_ptr<const Event> event) const = 0;
     virtual std::vector<std::shared_ptr<const Event>> execute_on_entry(const State& state) const = 0;
     virtual std::vector<std::shared_ptr<const Event>> execute_on_exit(const State& state) const = 0;
+    virtual std::vector<std::shared_ptr<const Event>> execute_on_entryexit(on_entryexit_func func) const = 0;
+
+    // Same as execute_action() and execute_on_entryexit(), appending the sent events to a vector the caller reuses.
+    virtual void execute_action_into(const Transition& transition, std::shared_ptr<const Event> event,
+                                     std::vector<std::shared_ptr<const Event>>& sent_events) const {
+        auto ret = execute_action(transition, std::move(event));
+        std::move(ret.begin(), ret.end(), std::back_inserter(sent_events));
+    }
+
+    virtual void execute_on_entryexit_into(on_entryexit_func func, std::vector<std::shared_ptr<const Event>>& sent_events) const {
+        auto ret = execute_on_entryexit(func);
+        std::move(ret.begin(), ret.end(), std::back_inserter(sent_events));
+    }
+
     virtual ~Evaluator() {}
 };
 
@@ -0,0 +1,713 @@
+#ifndef INCLUDE_SISMICPP_CODEGEN_GENERATOR
+#define INCLUDE_SISMICPP_CODEGEN_GENERATOR
+
+#include "model/compiled.h"
+#include "model/context.h"
+#include "model/elements.h"
+#include "exceptions.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace sismicpp {
+namespace codegen {
+
+// Names under which guards, actions, entry/exit functions and preambles are referenced in generated code,
+// since a function pointer carries no name. Names may be qualified, and must be declared by one of the includes.
+struct FunctionSymbols {
+private:
+    std::map<guard_func, std::string> guards = {};
+    std::map<action_func, std::string> actions = {};
+    std::map<on_entryexit_func, std::string> entryexits = {};
+    std::map<preamble_func, std::string> preambles = {};
+
+    template <typename Func>
+    static const std::string& name_for(const std::map<Func, std::string>& names, Func func, const std::string& what) {
+        auto it = names.find(func);
+        if (it == names.end()) {
+            throw sismic_error("No symbol for " + what);
+        }
+        return it->second;
+    }
+
+public:
+    FunctionSymbols& add(guard_func func, std::string name) {
+        guards[func] = std::move(name);
+        return *this;
+    }
+
+    FunctionSymbols& add(action_func func, std::string name) {
+        actions[func] = std::move(name);
+        return *this;
+    }
+
+    FunctionSymbols& add(on_entryexit_func func, std::string name) {
+        entryexits[func] = std::move(name);
+        return *this;
+    }
+
+    FunctionSymbols& add(preamble_func func, std::string name) {
+        preambles[func] = std::move(name);
+        return *this;
+    }
+
+    const std::string& name_for(guard_func func, const std::string& what) const {
+        return name_for(guards, func, what);
+    }
+
+    const std::string& name_for(action_func func, const std::string& what) const {
+        return name_for(actions, func, what);
+    }
+
+    const std::string& name_for(on_entryexit_func func, const std::string& what) const {
+        return name_for(entryexits, func, what);
+    }
+
+    const std::string& name_for(preamble_func func, const std::string& what) const {
+        return name_for(preambles, func, what);
+    }
+};
+
+struct CppOptions {
+    // Defaults to the statechart name, made into an identifier.
+    std::string class_name = "";
+    std::string name_space = "";
+    std::vector<std::string> includes = {};
+    // Without meta-events, listeners are never called and only the events needed by guards are raised.
+    bool meta_events = true;
+};
+
+namespace detail {
+
+inline bool is_keyword(const std::string& word) {
+    static const std::set<std::string> keywords = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+        "char", "char16_t", "char32_t", "class", "compl", "const", "constexpr", "const_cast", "continue", "decltype",
+        "default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false",
+        "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept",
+        "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+        "reinterpret_cast", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+        "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union",
+        "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"
+    };
+    return keywords.count(word) > 0;
+}
+
+// Identifiers for a list of names, unique among themselves.
+inline std::vector<std::string> make_identifiers(const std::vector<std::string>& names) {
+    std::vector<std::string> ret;
+    std::set<std::string> used;
+    for (size_t i = 0; i < names.size(); ++i) {
+        std::string identifier;
+        for (auto&& c : names[i]) {
+            identifier += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        }
+        if (identifier.empty() or std::isdigit(static_cast<unsigned char>(identifier[0])) or is_keyword(identifier) or
+            identifier[0] == '_') {
+            identifier = "s_" + identifier;
+        }
+        if (used.count(identifier)) {
+            identifier += "_" + std::to_string(i);
+        }
+        used.insert(identifier);
+        ret.push_back(std::move(identifier));
+    }
+    return ret;
+}
+
+inline std::string make_literal(const std::string& value) {
+    std::string ret = "\"";
+    for (auto&& c : value) {
+        if (c == '"' or c == '\\') {
+            ret += '\\';
+            ret += c;
+        } else if (c == '\n') {
+            ret += "\\n";
+        } else {
+            ret += c;
+        }
+    }
+    return ret + "\"";
+}
+
+struct CppGenerator {
+    const CompiledStateChart& statechart;
+    const FunctionSymbols& functions;
+    const CppOptions& options;
+
+    std::ostringstream out = {};
+    std::vector<std::string> states = {};
+    std::vector<std::string> events = {};
+    std::vector<symbol_id> event_symbols = {};
+    std::vector<size_t> history_index = {};
+    size_t history_count = 0;
+    bool has_guards = false;
+
+    CppGenerator(const CompiledStateChart& statechart, const FunctionSymbols& functions, const CppOptions& options) :
+    statechart(statechart),
+    functions(functions),
+    options(options) {
+        std::vector<std::string> state_names;
+        for (state_id id = 0; id < statechart.size(); ++id) {
+            state_names.push_back(statechart.name_for(id));
+        }
+        states = make_identifiers(state_names);
+
+        // An event may share its symbol with a state of the same name.
+        std::set<symbol_id> used_events;
+        for (auto&& transition : statechart.get_transitions()) {
+            if (transition.event != no_symbol) {
+                used_events.insert(transition.event);
+            }
+        }
+        std::vector<std::string> event_names;
+        for (auto&& symbol : used_events) {
+            event_names.push_back(statechart.get_symbols().name_for(symbol));
+            event_symbols.push_back(symbol);
+        }
+        events = make_identifiers(event_names);
+
+        history_index.assign(statechart.size(), 0);
+        for (state_id id = 0; id < statechart.size(); ++id) {
+            if (is_history(id)) {
+                history_index[id] = history_count++;
+            }
+        }
+
+        for (auto&& transition : statechart.get_transitions()) {
+            has_guards = has_guards or transition.transition->guard;
+        }
+    }
+
+    bool is_history(state_id id) const {
+        return statechart.is_history(id);
+    }
+
+    // The time provider of guards needs the step, entry and transition events, even without meta-events.
+    bool raises_time_events() const {
+        return options.meta_events or has_guards;
+    }
+
+    std::string class_name() const {
+        return options.class_name.empty() ? make_identifiers({statechart.get_statechart().name})[0] : options.class_name;
+    }
+
+    std::string enum_type() const {
+        auto count = statechart.get_symbols().size();
+        return count <= 0x100 ? "std::uint8_t" : count <= 0x10000 ? "std::uint16_t" : "std::uint32_t";
+    }
+
+    std::string describe(const CompiledTransition& transition) const {
+        return "transition from '" + statechart.name_for(transition.source) + "' on event '" + transition.transition->event + "'";
+    }
+
+    // Active states in the exit scope of an external transition, in exit order.
+    std::vector<state_id> exit_order(state_id exit_root) const {
+        std::vector<state_id> ret;
+        auto descendants = statechart.descendants_for(exit_root);
+        for (auto id = descendants.first; id < descendants.last; ++id) {
+            ret.push_back(id);
+        }
+        std::sort(ret.begin(), ret.end(), [&] (state_id s1, state_id s2) {
+            auto d1 = statechart.depth_for(s1);
+            auto d2 = statechart.depth_for(s2);
+            return d1 != d2 ? d1 > d2 : s1 > s2;
+        });
+        ret.push_back(exit_root);
+        return ret;
+    }
+
+    std::vector<state_id> by_depth(std::vector<state_id> ids, bool deepest_first) const {
+        std::sort(ids.begin(), ids.end(), [&] (state_id s1, state_id s2) {
+            auto d1 = statechart.depth_for(s1);
+            auto d2 = statechart.depth_for(s2);
+            if (d1 != d2) {
+                return deepest_first ? d1 > d2 : d1 < d2;
+            }
+            return statechart.rank_for(s1) < statechart.rank_for(s2);
+        });
+        return ids;
+    }
+
+    bool has_history_children(state_id id) const {
+        auto children = statechart.children_for(id);
+        return statechart.is_compound(id) and
+               std::any_of(children.begin(), children.end(), [&] (state_id child) { return is_history(child); });
+    }
+
+    std::string state(state_id id) const {
+        return std::to_string(id);
+    }
+
+    std::string generate() {
+        auto name = class_name();
+        std::string guard = "INCLUDE_SISMICPP_GENERATED_";
+        for (auto&& c : name) {
+            guard += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+
+        out << "// Generated by sismicpp::codegen::generate_cpp from statechart " << make_literal(statechart.get_statechart().name) << ", do not edit.\n";
+        out << "#ifndef " << guard << "\n";
+        out << "#define " << guard << "\n\n";
+        out << "#include \"codegen/runtime.h\"\n";
+        for (auto&& include : options.includes) {
+            out << "#include \"" << include << "\"\n";
+        }
+        out << "\n#include <cstddef>\n#include <cstdint>\n#include <memory>\n#include <string>\n#include <utility>\n#include <vector>\n\n";
+
+        if (!options.name_space.empty()) {
+            out << "namespace " << options.name_space << " {\n\n";
+        }
+
+        out << "struct " << name << " : sismicpp::codegen::Machine {\n";
+        generate_enums();
+        generate_members();
+        generate_constructor(name);
+        generate_queries();
+        generate_execute_once();
+
+        out << "private:\n";
+        generate_select_transitions();
+        generate_apply_transition();
+        generate_stabilize();
+        for (state_id id = 0; id < statechart.size(); ++id) {
+            generate_enter_exit(id);
+        }
+        for (state_id id = 0; id < statechart.size(); ++id) {
+            if (has_history_children(id)) {
+                generate_record_history(id);
+            }
+        }
+        out << "};\n";
+
+        if (!options.name_space.empty()) {
+            out << "\n}  // namespace " << options.name_space << "\n";
+        }
+        out << "\n#endif  // INCLUDE\n";
+        return out.str();
+    }
+
+    void generate_enums() {
+        out << "    enum class State : " << enum_type() << " {\n";
+        for (state_id id = 0; id < statechart.size(); ++id) {
+            out << "        " << states[id] << " = " << id << ",\n";
+        }
+        out << "    };\n\n";
+
+        out << "    enum class EventId : " << enum_type() << " {\n";
+        for (size_t i = 0; i < events.size(); ++i) {
+            out << "        " << events[i] << " = " << event_symbols[i] << ",\n";
+        }
+        out << "    };\n\n";
+
+        out << "    static constexpr std::size_t state_count = " << statechart.size() << ";\n";
+        out << "    static constexpr std::size_t transition_count = " << statechart.get_transitions().size() << ";\n\n";
+    }
+
+    void generate_members() {
+        out << "private:\n";
+        if (history_count > 0) {
+            out << "    sismicpp::Bitset memory[" << history_count << "];\n";
+            out << "    bool has_memory[" << history_count << "] = {};\n";
+        }
+        out << "    sismicpp::Bitset blocked = sismicpp::Bitset(state_count);\n";
+        out << "    sismicpp::Bitset snapshot = sismicpp::Bitset(state_count);\n\n";
+    }
+
+    void generate_constructor(const std::string& name) {
+        auto& symbols = statechart.get_symbols();
+        out << "public:\n";
+        out << "    explicit " << name << "(void* context = nullptr) :\n";
+        out << "    Machine(context, " << (options.meta_events ? "true" : "false") << ") {\n";
+        out << "        static const char* const names[] = {\n";
+        for (symbol_id symbol = 0; symbol < symbols.size(); ++symbol) {
+            out << "            " << make_literal(symbols.name_for(symbol)) << ",\n";
+        }
+        out << "        };\n";
+        out << "        for (auto&& name : names) {\n";
+        out << "            symbols.intern(name);\n";
+        out << "        }\n";
+        out << "        configuration = sismicpp::Bitset(state_count);\n";
+        if (!has_guards) {
+            out << "        time_provider.subscriptions = sismicpp::mask_for(sismicpp::MetaEventKind::step_started);\n";
+        }
+        if (history_count > 0) {
+            out << "        for (auto&& recorded : memory) {\n";
+            out << "            recorded = sismicpp::Bitset(state_count);\n";
+            out << "        }\n";
+        }
+        auto preamble = statechart.get_statechart().preamble;
+        if (preamble) {
+            out << "        " << functions.name_for(preamble, "the preamble") << "(context);\n";
+        }
+        out << "    }\n\n";
+    }
+
+    void generate_queries() {
+        auto& transitions = statechart.get_transitions();
+
+        out << "    using Machine::is_active;\n\n";
+        out << "    bool is_active(State state) const {\n";
+        out << "        return configuration.test(static_cast<sismicpp::symbol_id>(state));\n";
+        out << "    }\n\n";
+
+        out << "    static const sismicpp::Transition& transition_for(std::size_t id) {\n";
+        if (transitions.empty()) {
+            out << "        static const sismicpp::Transition transitions[1] = {sismicpp::Transition{\"\"}};\n";
+        } else {
+            out << "        static const sismicpp::Transition transitions[] = {\n";
+            for (auto&& compiled_transition : transitions) {
+                auto& transition = *compiled_transition.transition;
+                out << "            sismicpp::Transition{" << make_literal(transition.source) << ", " << make_literal(transition.target)
+                    << ", " << make_literal(transition.event) << ", ";
+                out << (transition.guard ? functions.name_for(transition.guard, "the guard of the " + describe(compiled_transition)) : "nullptr") << ", ";
+                out << (transition.action ? functions.name_for(transition.action, "the action of the " + describe(compiled_transition)) : "nullptr") << ", ";
+                out << transition.priority << "},\n";
+            }
+            out << "        };\n";
+        }
+        out << "        return transitions[id];\n";
+        out << "    }\n\n";
+
+        out << "    static const char* name_for(State state) {\n";
+        out << "        switch (state) {\n";
+        for (state_id id = 0; id < statechart.size(); ++id) {
+            out << "        case State::" << states[id] << ": return " << make_literal(statechart.name_for(id)) << ";\n";
+        }
+        out << "        }\n";
+        out << "        return \"\";\n";
+        out << "    }\n\n";
+    }
+
+    void generate_execute_once() {
+        out << "    std::unique_ptr<sismicpp::MacroStep> execute_once() override {\n";
+        if (raises_time_events()) {
+            out << "        raise_step_event(sismicpp::MetaEventKind::step_started);\n";
+        }
+        out << "        std::vector<sismicpp::MicroStep> steps;\n\n";
+        out << "        if (!initialized) {\n";
+        out << "            initialized = true;\n";
+        out << "            sismicpp::MicroStep step;\n";
+        out << "            enter_" << states[statechart.get_root()] << "(step);\n";
+        out << "            finish_step(step);\n";
+        out << "            steps.push_back(std::move(step));\n";
+        out << "            stabilize(steps);\n";
+        out << "        } else {\n";
+        out << "            auto queued = select_event();\n";
+        out << "            auto event = queued ? queued->event : nullptr;\n";
+        out << "            std::size_t selected[" << std::max<size_t>(statechart.get_transitions().size(), 1) << "];\n";
+        out << "            auto selected_count = select_transitions(event.get(), queued ? queued->symbol : sismicpp::no_symbol, selected);\n";
+        out << "            if (selected_count == 0) {\n";
+        out << "                if (event) {\n";
+        out << "                    consume_event();\n";
+        out << "                    sismicpp::MicroStep step;\n";
+        out << "                    step.event = event;\n";
+        out << "                    steps.push_back(std::move(step));\n";
+        out << "                    stabilize(steps);\n";
+        out << "                }\n";
+        out << "            } else {\n";
+        out << "                if (transition_for(selected[0]).is_eventless()) {\n";
+        out << "                    event = nullptr;\n";
+        out << "                } else {\n";
+        out << "                    consume_event();\n";
+        out << "                }\n\n";
+        out << "                // Exits are computed against the configuration before any of the selected transitions is processed.\n";
+        out << "                const sismicpp::Bitset* active = &configuration;\n";
+        out << "                if (selected_count > 1) {\n";
+        out << "                    snapshot = configuration;\n";
+        out << "                    active = &snapshot;\n";
+        out << "                }\n";
+        out << "                for (std::size_t i = 0; i < selected_count; ++i) {\n";
+        out << "                    apply_transition(selected[i], *active, event, steps);\n";
+        out << "                    stabilize(steps);\n";
+        out << "                }\n";
+        out << "            }\n";
+        out << "        }\n\n";
+        out << "        std::unique_ptr<sismicpp::MacroStep> macro_step;\n";
+        out << "        if (!steps.empty()) {\n";
+        out << "            macro_step = std::make_unique<sismicpp::MacroStep>(sismicpp::MacroStep{clock->get_time(), std::move(steps)});\n";
+        out << "        }\n";
+        if (options.meta_events) {
+            out << "        raise_step_event(sismicpp::MetaEventKind::step_ended);\n";
+        }
+        out << "        return macro_step;\n";
+        out << "    }\n\n";
+    }
+
+    // Candidates come in the order of the dispatch index: by source, then by decreasing priority.
+    void generate_candidates(Range<transition_id> candidates, const std::string& exposed_event, const std::string& indent) {
+        auto it = candidates.begin();
+        while (it != candidates.end()) {
+            auto source = statechart.transition_for(*it).source;
+            auto source_end = std::find_if(it, candidates.end(), [&] (transition_id id) {
+                return statechart.transition_for(id).source != source;
+            });
+
+            out << indent << "if (configuration.test(" << state(source) << ") and !blocked.test(" << state(source) << ")) {\n";
+            out << indent << "    found = false;\n";
+            auto first_group = true;
+            while (it != source_end) {
+                auto priority = statechart.transition_for(*it).transition->priority;
+                auto group_indent = indent + "    ";
+                if (!first_group) {
+                    out << indent << "    if (!found) {\n";
+                    group_indent += "    ";
+                }
+                for (; it != source_end and statechart.transition_for(*it).transition->priority == priority; ++it) {
+                    auto& transition = statechart.transition_for(*it);
+                    if (transition.transition->guard) {
+                        out << group_indent << "{\n";
+                        out << group_indent << "    sismicpp::CppGuardContext guard_context(time_provider, *this, symbols.name_for("
+                            << state(source) << "), " << exposed_event << ");\n";
+                        out << group_indent << "    if (" << functions.name_for(transition.transition->guard, "the guard of the " + describe(transition))
+                            << "(context, guard_context)) {\n";
+                        out << group_indent << "        selected[count++] = " << transition.id << ";\n";
+                        out << group_indent << "        found = true;\n";
+                        out << group_indent << "    }\n";
+                        out << group_indent << "}\n";
+                    } else {
+                        out << group_indent << "selected[count++] = " << transition.id << ";\n";
+                        out << group_indent << "found = true;\n";
+                    }
+                }
+                if (!first_group) {
+                    out << indent << "    }\n";
+                }
+                first_group = false;
+            }
+
+            // Sources that are a selected source or one of its ancestors are ignored (inner-first).
+            out << indent << "    if (found) {\n";
+            out << indent << "        blocked.set(" << state(source) << ");\n";
+            for (auto&& ancestor : statechart.ancestors_for(source)) {
+                out << indent << "        blocked.set(" << state(ancestor) << ");\n";
+            }
+            out << indent << "    }\n";
+            out << indent << "}\n";
+        }
+    }
+
+    void generate_select_transitions() {
+        out << "    std::size_t select_transitions(const sismicpp::Event* event, sismicpp::symbol_id symbol, std::size_t* selected) {\n";
+        out << "        std::size_t count = 0;\n";
+        out << "        bool found = false;\n";
+        out << "        blocked.clear();\n\n";
+        generate_candidates(statechart.eventless_transitions(), "nullptr", "        ");
+        out << "        if (count == 0 and event) {\n";
+        out << "            switch (symbol) {\n";
+        for (size_t i = 0; i < events.size(); ++i) {
+            auto candidates = statechart.transitions_for_event(event_symbols[i]);
+            if (candidates.empty()) {
+                continue;
+            }
+            out << "            case static_cast<sismicpp::symbol_id>(EventId::" << events[i] << "):\n";
+            generate_candidates(candidates, "event", "                ");
+            out << "                break;\n";
+        }
+        out << "            default:\n";
+        out << "                break;\n";
+        out << "            }\n";
+        out << "        }\n\n";
+        out << "        (void) found;\n";
+        out << "        return count;\n";
+        out << "    }\n\n";
+    }
+
+    void generate_apply_transition() {
+        out << "    void apply_transition(std::size_t id, const sismicpp::Bitset& active, std::shared_ptr<const sismicpp::Event> event,\n";
+        out << "                          std::vector<sismicpp::MicroStep>& steps) {\n";
+        out << "        (void) active;\n";
+        out << "        sismicpp::MicroStep step;\n";
+        out << "        step.event = event;\n";
+        out << "        step.transition = &transition_for(id);\n\n";
+        out << "        switch (id) {\n";
+        for (auto&& transition : statechart.get_transitions()) {
+            out << "        case " << transition.id << ": {\n";
+            if (!transition.is_internal()) {
+                auto exited = exit_order(transition.exit_root);
+                // History is recorded against the configuration as it was before any state is exited.
+                for (auto&& id : exited) {
+                    if (has_history_children(id)) {
+                        out << "            if (active.test(" << state(id) << ")) {\n";
+                        out << "                record_history_" << states[id] << "();\n";
+                        out << "            }\n";
+                    }
+                }
+                for (auto&& id : exited) {
+                    out << "            if (active.test(" << state(id) << ")) {\n";
+                    out << "                exit_" << states[id] << "(step);\n";
+                    out << "            }\n";
+                }
+            }
+            if (transition.transition->action) {
+                out << "            {\n";
+                out << "                sismicpp::CppActionContext action_context(time_provider, *this, event, sent_events, event_pool.get());\n";
+                out << "                " << functions.name_for(transition.transition->action, "the action of the " + describe(transition))
+                    << "(context, action_context);\n";
+                out << "            }\n";
+            }
+            if (raises_time_events()) {
+                out << "            raise_transition_processed(" << state(transition.source) << ", "
+                    << (transition.is_internal() ? "sismicpp::no_symbol" : state(transition.target)) << ", event);\n";
+            }
+            for (auto&& id : transition.entry_path) {
+                out << "            enter_" << states[id] << "(step);\n";
+            }
+            out << "            break;\n";
+            out << "        }\n";
+        }
+        out << "        default:\n";
+        out << "            break;\n";
+        out << "        }\n\n";
+        out << "        finish_step(step);\n";
+        out << "        steps.push_back(std::move(step));\n";
+        out << "    }\n\n";
+    }
+
+    void generate_entries(const std::vector<state_id>& entered, const std::string& indent) {
+        for (auto&& id : entered) {
+            out << indent << "enter_" << states[id] << "(step);\n";
+        }
+    }
+
+    void generate_stabilize() {
+        auto root = statechart.get_root();
+
+        out << "    void stabilize(std::vector<sismicpp::MicroStep>& steps) {\n";
+        out << "        while (stabilize_once(steps)) {}\n";
+        out << "    }\n\n";
+
+        // Leaves are considered deepest first, then by name, and the first one that is not stable is completed.
+        out << "    bool stabilize_once(std::vector<sismicpp::MicroStep>& steps) {\n";
+        out << "        sismicpp::MicroStep step;\n";
+        std::vector<state_id> all;
+        for (state_id id = 0; id < statechart.size(); ++id) {
+            all.push_back(id);
+        }
+        for (auto&& id : by_depth(all, true)) {
+            auto descendants = statechart.descendants_for(id);
+            if (statechart.is_final(id) and statechart.parent_for(id) == root) {
+                out << "        if (configuration.test(" << state(id) << ")) {\n";
+                if (has_history_children(root)) {
+                    out << "            record_history_" << states[root] << "();\n";
+                }
+                out << "            exit_" << states[id] << "(step);\n";
+                out << "            exit_" << states[root] << "(step);\n";
+            } else if (is_history(id)) {
+                out << "        if (configuration.test(" << state(id) << ")) {\n";
+                out << "            exit_" << states[id] << "(step);\n";
+                out << "            if (has_memory[" << history_index[id] << "]) {\n";
+                auto parent = statechart.parent_for(id);
+                std::vector<state_id> remembered;
+                if (statechart.is_deep_history(id)) {
+                    auto scope = statechart.descendants_for(parent);
+                    for (auto state = scope.first; state < scope.last; ++state) {
+                        remembered.push_back(state);
+                    }
+                } else {
+                    auto children = statechart.children_for(parent);
+                    remembered.assign(children.begin(), children.end());
+                }
+                for (auto&& state : by_depth(remembered, false)) {
+                    out << "                if (memory[" << history_index[id] << "].test(" << this->state(state) << ")) {\n";
+                    out << "                    enter_" << states[state] << "(step);\n";
+                    out << "                }\n";
+                }
+                out << "            }";
+                auto initial = statechart.initial_for(id);
+                if (initial != no_state) {
+                    out << " else {\n";
+                    auto closure = statechart.closure_for(initial);
+                    std::vector<state_id> entered = {initial};
+                    entered.insert(entered.end(), closure.begin(), closure.end());
+                    generate_entries(entered, "                ");
+                    out << "            }";
+                }
+                out << "\n";
+            } else if (statechart.is_composite(id)) {
+                auto closure = statechart.closure_for(id);
+                if (closure.empty()) {
+                    continue;
+                }
+                out << "        if (configuration.test(" << state(id) << ") and configuration.find_next("
+                    << descendants.first << ", " << descendants.last << ") == " << descendants.last << ") {\n";
+                generate_entries(std::vector<state_id>(closure.begin(), closure.end()), "            ");
+            } else {
+                continue;
+            }
+            out << "            finish_step(step);\n";
+            out << "            steps.push_back(std::move(step));\n";
+            out << "            return true;\n";
+            out << "        }\n";
+        }
+        out << "        return false;\n";
+        out << "    }\n\n";
+    }
+
+    void generate_enter_exit(state_id id) {
+        auto& name = statechart.name_for(id);
+        auto generate = [&] (const char* direction, on_entryexit_func func, const char* update, const char* event, bool raised, const char* names) {
+            out << "    void " << direction << "_" << states[id] << "(sismicpp::MicroStep& step) {\n";
+            if (func) {
+                out << "        {\n";
+                out << "            sismicpp::CppOnEntryExitContext entryexit_context(time_provider, *this, sent_events, event_pool.get());\n";
+                out << "            " << functions.name_for(func, std::string(direction == std::string("enter") ? "on_entry" : "on_exit") + " of state '" + name + "'")
+                    << "(context, entryexit_context);\n";
+                out << "        }\n";
+            }
+            out << "        configuration." << update << "(" << this->state(id) << ");\n";
+            if (raised) {
+                out << "        raise_state_event(sismicpp::MetaEventKind::" << event << ", " << this->state(id) << ");\n";
+            }
+            out << "        step." << names << ".push_back(symbols.name_for(" << this->state(id) << "));\n";
+            out << "    }\n\n";
+        };
+        generate("enter", statechart.on_entry_for(id), "set", "state_entered", raises_time_events(), "entered_states");
+        generate("exit", statechart.on_exit_for(id), "reset", "state_exited", options.meta_events, "exited_states");
+    }
+
+    // Remember the active children (shallow) or descendants (deep) of the state for each of its history states.
+    void generate_record_history(state_id id) {
+        out << "    void record_history_" << states[id] << "() {\n";
+        for (auto&& child : statechart.children_for(id)) {
+            if (!is_history(child)) {
+                continue;
+            }
+            auto index = history_index[child];
+            out << "        memory[" << index << "].clear();\n";
+            if (statechart.is_deep_history(child)) {
+                auto descendants = statechart.descendants_for(id);
+                out << "        for (auto&& state : configuration.ones(" << descendants.first << ", " << descendants.last << ")) {\n";
+                out << "            memory[" << index << "].set(state);\n";
+                out << "        }\n";
+            } else {
+                for (auto&& state : statechart.children_for(id)) {
+                    out << "        if (configuration.test(" << this->state(state) << ")) {\n";
+                    out << "            memory[" << index << "].set(" << this->state(state) << ");\n";
+                    out << "        }\n";
+                }
+            }
+            out << "        has_memory[" << index << "] = true;\n";
+        }
+        out << "    }\n\n";
+    }
+};
+
+}  // namespace detail
+
+// Emits a header defining a machine that is observably equivalent to running the statechart with
+// sismicpp::Interpreter, with selection, exits, entries and stabilization unrolled into switches.
+inline std::string generate_cpp(const CompiledStateChart& statechart, const FunctionSymbols& functions, const CppOptions& options = {}) {
+    return detail::CppGenerator(statechart, functions, options).generate();
+}
+
+}  // namespace codegen
+}  // namespace sismicpp
+
+#endif  // INCLUDE
@@ -0,0 +1,255 @@
+#ifndef INCLUDE_SISMICPP_CODEGEN_RUNTIME
+#define INCLUDE_SISMICPP_CODEGEN_RUNTIME
+
+#include "utilities.h"
+#include "model/context.h"
+#include "model/elements.h"
+#include "model/events.h"
+#include "model/pool.h"
+#include "model/steps.h"
+#include "model/symbols.h"
+#include "clock/clock.h"
+#include "code/attachable.h"
+#include "code/context.h"
+#include "code/cpp.h"
+#include "interpreter/queue.h"
+#include "exceptions.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sismicpp {
+namespace codegen {
+
+// Base of the machines emitted by generate_cpp(): event queues, clock, listeners and meta-events,
+// shared with sismicpp::Interpreter. Selection, exits, entries and stabilization are emitted per statechart.
+struct Machine : Observable, ActiveStatesProvider {
+protected:
+    void* context;
+    bool meta_events;
+    SymbolTable symbols = {};
+    Bitset configuration = {};
+    bool initialized = false;
+    EventQueue internal_queue = {};
+    EventQueue external_queue = {};
+    ListenerSet listeners = {};
+    TimeContextProvider time_provider = {};
+    // Queued, sent and meta-events are allocated from the pool.
+    EventPool::Owner event_pool = EventPool::create();
+    MetaEventSlots meta_event_slots = {};
+
+    // Events sent by the actions and entry/exit functions of the current micro step.
+    std::vector<std::shared_ptr<const Event>> sent_events = {};
+
+public:
+    std::unique_ptr<Clock> clock = std::make_unique<SimulatedClock>();
+
+    Machine(void* context, bool meta_events) :
+    context(context),
+    meta_events(meta_events) {}
+
+    std::vector<std::string> get_configuration() const {
+        std::vector<std::string> ret;
+        for (auto&& id : configuration.ones()) {
+            ret.push_back(symbols.name_for(static_cast<symbol_id>(id)));
+        }
+        return ret;
+    }
+
+    Bitset::View get_active_states() const {
+        return configuration.ones();
+    }
+
+    bool is_active(symbol_id id) const {
+        return configuration.test(id);
+    }
+
+    bool is_active(const std::string& name) const override {
+        auto id = symbols.find(name);
+        return id != no_symbol and id < configuration.size() and configuration.test(id);
+    }
+
+    bool is_in_final() const {
+        return initialized and !configuration.any();
+    }
+
+    EventPool& get_event_pool() const {
+        return *event_pool;
+    }
+
+    // Listeners only receive meta-events if the machine was generated with them.
+    void attach(Attachable* listener) override {
+        listeners.attach(listener);
+    }
+
+    void detach(Attachable* listener) override {
+        listeners.detach(listener);
+    }
+
+    Machine& queue(std::shared_ptr<const Event> event) {
+        auto handle = handle_for(*event);
+        push_event(std::move(event), std::move(handle));
+        return *this;
+    }
+
+    Machine& queue(std::string name) {
+        queue(make_pooled<Event>(event_pool.get(), std::move(name)));
+        return *this;
+    }
+
+    // Same as queue(), with a handle to cancel the event. Sent events keep the handle returned by send().
+    EventHandle schedule(std::shared_ptr<const Event> event) {
+        auto handle = handle_for(*event);
+        if (!handle.valid()) {
+            handle = EventHandle::create(event_pool.get());
+        }
+        push_event(std::move(event), handle);
+        return handle;
+    }
+
+    EventHandle schedule(std::string name) {
+        return schedule(make_pooled<Event>(event_pool.get(), std::move(name)));
+    }
+
+    virtual std::unique_ptr<MacroStep> execute_once() = 0;
+
+    std::vector<MacroStep> execute() {
+        std::vector<MacroStep> ret;
+
+        auto macro_step = execute_once();
+
+        while (macro_step) {
+            ret.push_back(std::move(*macro_step));
+            macro_step = execute_once();
+        }
+
+        return ret;
+    }
+
+protected:
+    void push_event(std::shared_ptr<const Event> event, EventHandle handle) {
+        QueuedEvent queued{
+            .time=clock->get_time() + event->delay,
+            .symbol=symbols.find(event->name),
+            .event=std::move(event),
+            .handle=std::move(handle)
+        };
+
+        auto& queue = queued.event->is_internal_event() ? internal_queue : external_queue;
+        queue.advance(clock->get_time());
+        queue.push(std::move(queued));
+    }
+
+    // The time provider sees meta-events even without meta_events, since guards rely on it for after() and idle().
+    bool wants(MetaEventKind kind) const {
+        return (time_provider.get_subscriptions() & mask_for(kind)) != 0 or (meta_events and listeners.wants(kind));
+    }
+
+    void raise_event(std::shared_ptr<const MetaEvent> event) {
+        if (time_provider.get_subscriptions() & mask_for(event->kind)) {
+            time_provider(event);
+        }
+        if (meta_events) {
+            listeners.notify(event);
+        }
+    }
+
+    // Fills and raises a meta-event, if the time provider or a listener subscribed to its kind.
+    template <typename Fill>
+    void raise_meta_event(MetaEventKind kind, Fill fill) {
+        if (!wants(kind)) {
+            return;
+        }
+        auto event = meta_event_slots.acquire(event_pool.get(), kind, clock->get_time(), symbols);
+        fill(*event);
+        raise_event(std::shared_ptr<const MetaEvent>(std::move(event)));
+    }
+
+    void raise_event(std::shared_ptr<const InternalEvent> event) {
+        raise_meta_event(MetaEventKind::event_sent, [&] (MetaEvent& event_sent) {
+            event_sent.event = event;
+        });
+        queue(std::move(event));
+    }
+
+    // Contexts may hand back any Event, so the kind decides which downcast is safe.
+    void raise_event(std::shared_ptr<const Event> event) {
+        switch (event->get_kind()) {
+            case EventKind::internal:
+                raise_event(std::static_pointer_cast<const InternalEvent>(std::move(event)));
+                break;
+            case EventKind::meta:
+                raise_event(std::static_pointer_cast<const MetaEvent>(std::move(event)));
+                break;
+            case EventKind::external:
+                throw sismic_error("Event " + event->name + " was sent without send() or notify()");
+        }
+    }
+
+    void raise_step_event(MetaEventKind kind) {
+        raise_meta_event(kind, [] (MetaEvent&) {});
+    }
+
+    void raise_state_event(MetaEventKind kind, symbol_id state) {
+        raise_meta_event(kind, [state] (MetaEvent& event) {
+            event.state = state;
+        });
+    }
+
+    void raise_transition_processed(symbol_id source, symbol_id target, const std::shared_ptr<const Event>& event) {
+        raise_meta_event(MetaEventKind::transition_processed, [&] (MetaEvent& transition_processed) {
+            transition_processed.source = source;
+            transition_processed.target = target;
+            transition_processed.event = event;
+        });
+    }
+
+    // Makes the delayed events that are due ready first.
+    const QueuedEvent* select_event() {
+        internal_queue.advance(clock->get_time());
+        external_queue.advance(clock->get_time());
+
+        auto select_from_queue = [&] (auto& queue) -> const QueuedEvent* {
+            if (!queue.empty()) {
+                if (queue.front().time <= clock->get_time()) {
+                    return &queue.front();
+                }
+            }
+            return nullptr;
+        };
+
+        auto queued = select_from_queue(internal_queue);
+        if (!queued) {
+            queued = select_from_queue(external_queue);
+        }
+
+        return queued;
+    }
+
+    // Pops the event returned by select_event().
+    void consume_event() {
+        auto& queue = !internal_queue.empty() and internal_queue.front().time <= clock->get_time() ? internal_queue : external_queue;
+        auto event = queue.pop().event;
+
+        raise_meta_event(MetaEventKind::event_consumed, [&event] (MetaEvent& event_consumed) {
+            event_consumed.event = std::move(event);
+        });
+    }
+
+    // Raises the events sent during the micro step, once all of its states are entered.
+    void finish_step(MicroStep& step) {
+        for (auto& event : sent_events) {
+            raise_event(event);
+        }
+        step.sent_events = std::move(sent_events);
+        sent_events.clear();
+    }
+};
+
+}  // namespace codegen
+}  // namespace sismicpp
+
+#endif  // INCLUDE
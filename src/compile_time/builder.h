@@ -0,0 +1,279 @@
+#ifndef INCLUDE_SISMICPP_COMPILE_TIME_BUILDER
+#define INCLUDE_SISMICPP_COMPILE_TIME_BUILDER
+
+#include "compile_time/statechart.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+namespace sismicpp {
+namespace compile_time {
+namespace builder {
+namespace detail {
+
+struct NameAttribute { Name value; };
+struct DescriptionAttribute { Name value; };
+struct InitialAttribute { Name value; };
+struct MemoryAttribute { Name value; };
+struct TypeAttribute { StateKind kind; bool is_known; };
+struct OnEntryAttribute { entryexit_fn value; };
+struct OnExitAttribute { entryexit_fn value; };
+struct EventAttribute { Name value; };
+struct TargetAttribute { Name value; };
+struct GuardAttribute { guard_fn value; };
+struct ActionAttribute { action_fn value; };
+struct PriorityAttribute { std::int32_t value; };
+
+struct PartialTransition {
+    StaticTransition transition;
+};
+
+constexpr void apply(StaticTransition& transition, EventAttribute attribute) { transition.event_name = attribute.value; }
+constexpr void apply(StaticTransition& transition, TargetAttribute attribute) { transition.target_name = attribute.value; }
+constexpr void apply(StaticTransition& transition, GuardAttribute attribute) { transition.guard = attribute.value; }
+constexpr void apply(StaticTransition& transition, ActionAttribute attribute) { transition.action = attribute.value; }
+constexpr void apply(StaticTransition& transition, PriorityAttribute attribute) { transition.priority = attribute.value; }
+
+constexpr std::size_t sum() {
+    return 0;
+}
+
+template <typename... Rest>
+constexpr std::size_t sum(std::size_t first, Rest... rest) {
+    return first + sum(rest...);
+}
+
+template <typename Arg>
+struct counts {
+    static constexpr std::size_t states = 0;
+    static constexpr std::size_t transitions = 0;
+};
+
+template <>
+struct counts<PartialTransition> {
+    static constexpr std::size_t states = 0;
+    static constexpr std::size_t transitions = 1;
+};
+
+// Attributes of a state being built, folded into its StaticState once all arguments are applied.
+struct StateFlags {
+    bool is_parallel = false;
+    bool has_children = false;
+    bool has_transitions = false;
+    bool has_type = false;
+    TypeAttribute type = {};
+};
+
+template <typename... Args>
+struct PartialState {
+    static constexpr std::size_t states = 1 + sum(counts<Args>::states...);
+    static constexpr std::size_t transitions = sum(counts<Args>::transitions...);
+
+    bool is_parallel;
+    std::tuple<Args...> args;
+
+    // States are added depth-first in pre-order, like the dynamic builder.
+    template <typename Chart>
+    constexpr void add_states(Chart& chart, state_index parent) const {
+        auto id = chart.add_state(parent);
+        StateFlags flags{};
+        flags.is_parallel = is_parallel;
+        add_states(chart, id, flags, std::index_sequence_for<Args...>{});
+
+        auto& state = chart.states[id];
+        if (flags.has_type) {
+            if (!flags.type.is_known) {
+                chart.fail(ValidationError::unknown_type);
+            } else if (flags.is_parallel) {
+                chart.fail(ValidationError::typed_parallel_state);
+            } else if (flags.has_children) {
+                chart.fail(ValidationError::typed_compound_state);
+            } else if (flags.has_transitions) {
+                chart.fail(ValidationError::typed_state_with_transitions);
+            }
+            state.kind = flags.type.kind;
+        } else if (flags.is_parallel) {
+            state.kind = StateKind::orthogonal;
+        } else if (flags.has_children) {
+            state.kind = StateKind::compound;
+        }
+    }
+
+    // Transitions of a state come before the ones of its descendants, like the dynamic builder.
+    template <typename Chart>
+    constexpr void add_transitions(Chart& chart, std::size_t& next_id) const {
+        auto id = static_cast<state_index>(next_id++);
+        add_own_transitions(chart, id, std::index_sequence_for<Args...>{});
+        add_inner_transitions(chart, next_id, std::index_sequence_for<Args...>{});
+    }
+
+private:
+    template <typename Chart, std::size_t... I>
+    constexpr void add_states(Chart& chart, state_index id, StateFlags& flags, std::index_sequence<I...>) const {
+        // Braced lists are evaluated left to right, so arguments apply in the order they are written.
+        int ordered[] = {0, (add_state_arg(chart, id, flags, std::get<I>(args)), 0)...};
+        (void) ordered;
+    }
+
+    template <typename Chart, std::size_t... I>
+    constexpr void add_own_transitions(Chart& chart, state_index id, std::index_sequence<I...>) const {
+        int ordered[] = {0, (add_own_transition(chart, id, std::get<I>(args)), 0)...};
+        (void) ordered;
+    }
+
+    template <typename Chart, std::size_t... I>
+    constexpr void add_inner_transitions(Chart& chart, std::size_t& next_id, std::index_sequence<I...>) const {
+        int ordered[] = {0, (add_inner_transitions(chart, next_id, std::get<I>(args)), 0)...};
+        (void) ordered;
+    }
+
+    template <typename Chart>
+    static constexpr void add_state_arg(Chart& chart, state_index id, StateFlags&, NameAttribute attribute) {
+        chart.states[id].name = attribute.value;
+    }
+
+    template <typename Chart>
+    static constexpr void add_state_arg(Chart& chart, state_index id, StateFlags&, InitialAttribute attribute) {
+        chart.states[id].initial_name = attribute.value;
+    }
+
+    template <typename Chart>
+    static constexpr void add_state_arg(Chart& chart, state_index id, StateFlags&, MemoryAttribute attribute) {
+        chart.states[id].initial_name = attribute.value;
+    }
+
+    template <typename Chart>
+    static constexpr void add_state_arg(Chart&, state_index, StateFlags& flags, TypeAttribute attribute) {
+        flags.has_type = true;
+        flags.type = attribute;
+    }
+
+    template <typename Chart>
+    static constexpr void add_state_arg(Chart& chart, state_index id, StateFlags&, OnEntryAttribute attribute) {
+        chart.states[id].on_entry = attribute.value;
+    }
+
+    template <typename Chart>
+    static constexpr void add_state_arg(Chart& chart, state_index id, StateFlags&, OnExitAttribute attribute) {
+        chart.states[id].on_exit = attribute.value;
+    }
+
+    template <typename Chart>
+    static constexpr void add_state_arg(Chart&, state_index, StateFlags& flags, const PartialTransition&) {
+        flags.has_transitions = true;
+    }
+
+    template <typename Chart, typename... Inner>
+    static constexpr void add_state_arg(Chart& chart, state_index id, StateFlags& flags, const PartialState<Inner...>& inner_state) {
+        flags.has_children = true;
+        inner_state.add_states(chart, id);
+    }
+
+    template <typename Chart, typename Arg>
+    static constexpr void add_own_transition(Chart&, state_index, const Arg&) {}
+
+    template <typename Chart>
+    static constexpr void add_own_transition(Chart& chart, state_index id, const PartialTransition& partial_transition) {
+        chart.add_transition(id, partial_transition.transition);
+    }
+
+    template <typename Chart, typename Arg>
+    static constexpr void add_inner_transitions(Chart&, std::size_t&, const Arg&) {}
+
+    template <typename Chart, typename... Inner>
+    static constexpr void add_inner_transitions(Chart& chart, std::size_t& next_id, const PartialState<Inner...>& inner_state) {
+        inner_state.add_transitions(chart, next_id);
+    }
+};
+
+template <typename... Inner>
+struct counts<PartialState<Inner...>> {
+    static constexpr std::size_t states = PartialState<Inner...>::states;
+    static constexpr std::size_t transitions = PartialState<Inner...>::transitions;
+};
+
+template <typename Chart>
+constexpr void apply_statechart_arg(Chart& chart, NameAttribute attribute) {
+    chart.name = attribute.value;
+}
+
+template <typename Chart>
+constexpr void apply_statechart_arg(Chart& chart, DescriptionAttribute attribute) {
+    chart.description = attribute.value;
+}
+
+template <typename Chart, typename... Inner>
+constexpr void apply_statechart_arg(Chart& chart, const PartialState<Inner...>& root) {
+    root.add_states(chart, no_state);
+    std::size_t next_id = 0;
+    root.add_transitions(chart, next_id);
+}
+
+}  // namespace detail
+
+constexpr detail::NameAttribute name(Name value) { return {value}; }
+constexpr detail::DescriptionAttribute description(Name value) { return {value}; }
+constexpr detail::InitialAttribute initial(Name value) { return {value}; }
+constexpr detail::MemoryAttribute memory(Name value) { return {value}; }
+constexpr detail::OnEntryAttribute on_entry(entryexit_fn value) { return {value}; }
+constexpr detail::OnExitAttribute on_exit(entryexit_fn value) { return {value}; }
+
+constexpr detail::EventAttribute event(Name value) { return {value}; }
+constexpr detail::TargetAttribute target(Name value) { return {value}; }
+constexpr detail::GuardAttribute guard(guard_fn value) { return {value}; }
+constexpr detail::ActionAttribute action(action_fn value) { return {value}; }
+constexpr detail::PriorityAttribute priority(std::int32_t value) { return {value}; }
+
+// Unknown types are reported by StaticStateChart::check(), since this cannot throw in a constant expression.
+constexpr detail::TypeAttribute type(Name value) {
+    if (value == Name("final")) {
+        return {StateKind::final, true};
+    } else if (value == Name("shallow history")) {
+        return {StateKind::shallow_history, true};
+    } else if (value == Name("deep history")) {
+        return {StateKind::deep_history, true};
+    }
+    return {StateKind::basic, false};
+}
+
+template <typename... Args>
+constexpr detail::PartialTransition transition(Args... args) {
+    detail::PartialTransition partial_transition{};
+    int ordered[] = {0, (detail::apply(partial_transition.transition, args), 0)...};
+    (void) ordered;
+    return partial_transition;
+}
+
+template <typename... Args>
+constexpr detail::PartialState<Args...> state(Args... args) {
+    return {false, std::tuple<Args...>(args...)};
+}
+
+template <typename... Args>
+constexpr detail::PartialState<Args...> parallel_state(Args... args) {
+    return {true, std::tuple<Args...>(args...)};
+}
+
+template <typename... Args>
+constexpr detail::PartialState<Args...> root_state(Args... args) {
+    return {false, std::tuple<Args...>(args...)};
+}
+
+// Builds the tables of a statechart in a constant expression; check them with static_assert(statechart.validate(), "...").
+template <typename... Args>
+constexpr StaticStateChart<detail::sum(detail::counts<Args>::states...), detail::sum(detail::counts<Args>::transitions...)>
+build_statechart(Args... args) {
+    StaticStateChart<detail::sum(detail::counts<Args>::states...), detail::sum(detail::counts<Args>::transitions...)> statechart{};
+    int ordered[] = {0, (detail::apply_statechart_arg(statechart, args), 0)...};
+    (void) ordered;
+    statechart.compile();
+    return statechart;
+}
+
+}  // namespace builder
+}  // namespace compile_time
+}  // namespace sismicpp
+
+#endif  // INCLUDE
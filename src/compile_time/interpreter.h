@@ -0,0 +1,323 @@
+#ifndef INCLUDE_SISMICPP_COMPILE_TIME_INTERPRETER
+#define INCLUDE_SISMICPP_COMPILE_TIME_INTERPRETER
+
+#include "compile_time/statechart.h"
+#include "exceptions.h"
+
+#include <bitset>
+#include <cstddef>
+
+namespace sismicpp {
+namespace compile_time {
+
+// Interpreter over the tables of a StaticStateChart, with the semantics of sismicpp::Interpreter
+// (eventless transitions first, inner-first selection, default-entry closures, history) but
+// fixed-size storage only: no heap allocation, and events are queued by index rather than by name.
+// Guards, actions and entry/exit functions only receive the context pointer.
+template <std::size_t S, std::size_t T, std::size_t Q = 16>
+struct Interpreter {
+private:
+    const StaticStateChart<S, T>& statechart;
+    void* context;
+
+    bool initialized = false;
+    std::bitset<S> configuration = {};
+    std::bitset<S> memory[S] = {};
+    std::bitset<S> has_memory = {};
+
+    event_index events[Q] = {};
+    std::size_t first_event = 0;
+    std::size_t event_count = 0;
+
+public:
+    explicit Interpreter(const StaticStateChart<S, T>& statechart, void* context = nullptr) :
+    statechart(statechart),
+    context(context) {}
+
+    const StaticStateChart<S, T>& get_statechart() const {
+        return statechart;
+    }
+
+    bool is_active(state_index id) const {
+        return configuration.test(id);
+    }
+
+    bool is_in_final() const {
+        return initialized and configuration.none();
+    }
+
+    // Events that trigger no transition (no_event) are consumed without effect.
+    Interpreter& queue(event_index event) {
+        if (event_count == Q) {
+            throw sismic_error("Event queue is full");
+        }
+        events[(first_event + event_count++) % Q] = event;
+        return *this;
+    }
+
+    // Runs one macro step, returns false if there was nothing to do.
+    bool execute_once() {
+        if (!initialized) {
+            initialized = true;
+            enter(0);
+            stabilize();
+            return true;
+        }
+
+        auto has_event = event_count > 0;
+        auto event = has_event ? events[first_event] : no_event;
+
+        transition_index selected[T == 0 ? 1 : T] = {};
+        std::size_t selected_count = select_transitions(statechart.event_count, selected);
+        if (selected_count == 0 and has_event and event != no_event) {
+            selected_count = select_transitions(event, selected);
+        }
+
+        if (selected_count == 0) {
+            if (has_event) {
+                pop_event();
+            }
+            return has_event;
+        }
+
+        if (!statechart.transitions[selected[0]].is_eventless()) {
+            pop_event();
+        }
+
+        // Exits are computed against the configuration before any of the selected transitions is processed.
+        auto snapshot = configuration;
+        for (std::size_t i = 0; i < selected_count; ++i) {
+            apply_transition(statechart.transitions[selected[i]], snapshot);
+            stabilize();
+        }
+        return true;
+    }
+
+    std::size_t execute() {
+        std::size_t count = 0;
+        while (execute_once()) {
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    void pop_event() {
+        first_event = (first_event + 1) % Q;
+        --event_count;
+    }
+
+    bool is_history(state_index id) const {
+        auto kind = statechart.states[id].kind;
+        return kind == StateKind::shallow_history or kind == StateKind::deep_history;
+    }
+
+    // Same order and conflict resolution as the dynamic interpreter, over the precomputed dispatch order.
+    std::size_t select_transitions(std::size_t event, transition_index* selected) const {
+        state_index sources[S] = {};
+        std::size_t source_count = 0;
+        std::size_t selected_count = 0;
+
+        auto it = statechart.dispatch_offsets[event];
+        auto end = statechart.dispatch_offsets[event + 1];
+        while (it < end) {
+            auto source = statechart.transitions[statechart.dispatch[it]].source;
+            auto source_end = it;
+            while (source_end < end and statechart.transitions[statechart.dispatch[source_end]].source == source) {
+                ++source_end;
+            }
+
+            auto ignored = !configuration.test(source);
+            for (std::size_t i = 0; i < source_count and !ignored; ++i) {
+                ignored = source == sources[i] or statechart.is_descendant(sources[i], source);
+            }
+
+            while (!ignored and it < source_end) {
+                auto priority = statechart.transitions[statechart.dispatch[it]].priority;
+                auto found = false;
+                for (; it < source_end and statechart.transitions[statechart.dispatch[it]].priority == priority; ++it) {
+                    auto& transition = statechart.transitions[statechart.dispatch[it]];
+                    if (!transition.guard or transition.guard(context)) {
+                        selected[selected_count++] = statechart.dispatch[it];
+                        found = true;
+                    }
+                }
+                if (found) {
+                    sources[source_count++] = source;
+                    break;
+                }
+            }
+
+            it = source_end;
+        }
+
+        return selected_count;
+    }
+
+    void enter(state_index id) {
+        auto on_entry = statechart.states[id].on_entry;
+        if (on_entry) {
+            on_entry(context);
+        }
+        configuration.set(id);
+    }
+
+    void record_history(state_index id, state_index history) {
+        auto& recorded = memory[history];
+        recorded.reset();
+        for (auto state = id + 1u; state < statechart.states[id].subtree_end; ++state) {
+            if (configuration.test(state) and
+                (statechart.states[history].kind == StateKind::deep_history or statechart.states[state].parent == id)) {
+                recorded.set(state);
+            }
+        }
+        has_memory.set(history);
+    }
+
+    // Exited states are collected first, so that history is recorded before any of them is left.
+    void exit_all(const state_index* exited, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            auto& state = statechart.states[exited[i]];
+            if (state.kind == StateKind::compound) {
+                for (auto child = exited[i] + 1u; child < state.subtree_end; ++child) {
+                    if (statechart.states[child].parent == exited[i] and is_history(static_cast<state_index>(child))) {
+                        record_history(exited[i], static_cast<state_index>(child));
+                    }
+                }
+            }
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            auto& state = statechart.states[exited[i]];
+            if (state.on_exit) {
+                state.on_exit(context);
+            }
+            configuration.reset(exited[i]);
+        }
+    }
+
+    void apply_transition(const StaticTransition& transition, const std::bitset<S>& snapshot) {
+        if (transition.is_internal()) {
+            if (transition.action) {
+                transition.action(context);
+            }
+            return;
+        }
+
+        // Active descendants of the exit root, deepest first and in reverse document order within a level.
+        state_index exited[S] = {};
+        std::size_t exited_count = 0;
+        auto root = transition.exit_root;
+        auto end = statechart.states[root].subtree_end;
+        for (auto depth = S; depth > statechart.states[root].depth; --depth) {
+            for (auto id = end; id-- > root + 1u;) {
+                if (snapshot.test(id) and statechart.states[id].depth == depth) {
+                    exited[exited_count++] = static_cast<state_index>(id);
+                }
+            }
+        }
+        if (snapshot.test(root)) {
+            exited[exited_count++] = root;
+        }
+        exit_all(exited, exited_count);
+
+        if (transition.action) {
+            transition.action(context);
+        }
+
+        state_index entered[S] = {};
+        std::size_t entered_count = 0;
+        for (auto id = transition.target; id != no_state and statechart.states[id].depth > transition.lca_depth; id = statechart.states[id].parent) {
+            entered[entered_count++] = id;
+        }
+        while (entered_count > 0) {
+            enter(entered[--entered_count]);
+        }
+    }
+
+    // Enters the default-entry closure of a state, returns false if it stopped at a history state.
+    bool complete(state_index id) {
+        auto& state = statechart.states[id];
+        if (state.kind == StateKind::compound) {
+            if (state.initial == no_state) {
+                return true;
+            }
+            enter(state.initial);
+            return !is_history(state.initial) and complete(state.initial);
+        } else if (state.kind == StateKind::orthogonal) {
+            auto first = statechart.children_offsets[id];
+            auto last = statechart.children_offsets[id + 1];
+            for (auto i = first; i < last; ++i) {
+                enter(statechart.children[i]);
+            }
+            for (auto i = first; i < last; ++i) {
+                if (is_history(statechart.children[i]) or !complete(statechart.children[i])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool is_leaf(state_index id) const {
+        for (auto state = id + 1u; state < statechart.states[id].subtree_end; ++state) {
+            if (configuration.test(state)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void stabilize() {
+        while (stabilize_once()) {}
+    }
+
+    bool stabilize_once() {
+        for (std::size_t i = 0; i < S; ++i) {
+            auto leaf = statechart.stabilization_order[i];
+            if (!configuration.test(leaf) or !is_leaf(leaf)) {
+                continue;
+            }
+
+            auto& state = statechart.states[leaf];
+            if (state.kind == StateKind::final and state.parent == 0) {
+                state_index exited[] = {leaf, 0};
+                exit_all(exited, 2);
+                return true;
+            } else if (is_history(leaf)) {
+                state_index exited[] = {leaf};
+                exit_all(exited, 1);
+                if (has_memory.test(leaf)) {
+                    for (std::size_t j = 0; j < S; ++j) {
+                        auto id = statechart.restoration_order[j];
+                        if (memory[leaf].test(id)) {
+                            enter(id);
+                        }
+                    }
+                } else if (state.initial != no_state) {
+                    enter(state.initial);
+                    if (!is_history(state.initial)) {
+                        complete(state.initial);
+                    }
+                }
+                return true;
+            } else if (state.kind == StateKind::compound or state.kind == StateKind::orthogonal) {
+                if (state.kind == StateKind::compound ? state.initial != no_state :
+                    statechart.children_offsets[leaf] != statechart.children_offsets[leaf + 1]) {
+                    complete(leaf);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+template <std::size_t Q = 16, std::size_t S, std::size_t T>
+Interpreter<S, T, Q> make_interpreter(const StaticStateChart<S, T>& statechart, void* context = nullptr) {
+    return Interpreter<S, T, Q>(statechart, context);
+}
+
+}  // namespace compile_time
+}  // namespace sismicpp
+
+#endif  // INCLUDE
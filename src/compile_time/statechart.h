@@ -0,0 +1,447 @@
+#ifndef INCLUDE_SISMICPP_COMPILE_TIME_STATECHART
+#define INCLUDE_SISMICPP_COMPILE_TIME_STATECHART
+
+#include "model/kinds.h"
+#include "exceptions.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace sismicpp {
+namespace compile_time {
+
+using state_index = std::uint16_t;
+using transition_index = std::uint16_t;
+using event_index = std::uint16_t;
+
+constexpr state_index no_state = std::numeric_limits<state_index>::max();
+constexpr event_index no_event = std::numeric_limits<event_index>::max();
+
+using entryexit_fn = void (*)(void*);
+using guard_fn = bool (*)(const void*);
+using action_fn = void (*)(void*);
+
+// Non-owning view of a string literal, comparable in constant expressions.
+struct Name {
+    const char* data = "";
+    std::size_t size = 0;
+
+    constexpr Name() = default;
+
+    template <std::size_t N>
+    constexpr Name(const char (&literal)[N]) : data(literal), size(N - 1) {}
+
+    constexpr bool empty() const {
+        return size == 0;
+    }
+
+    constexpr bool operator==(const Name& other) const {
+        if (size != other.size) {
+            return false;
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            if (data[i] != other.data[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool operator!=(const Name& other) const {
+        return !(*this == other);
+    }
+
+    // Same order as std::string, so that name-based tie-breaks agree with the dynamic interpreter.
+    constexpr bool operator<(const Name& other) const {
+        for (std::size_t i = 0; i < size and i < other.size; ++i) {
+            auto first = static_cast<unsigned char>(data[i]);
+            auto second = static_cast<unsigned char>(other.data[i]);
+            if (first != second) {
+                return first < second;
+            }
+        }
+        return size < other.size;
+    }
+};
+
+// Fixed-size array whose elements can be written in constant expressions (std::array cannot in C++14).
+template <typename T, std::size_t N>
+struct FixedArray {
+    T values[N == 0 ? 1 : N] = {};
+
+    constexpr T& operator[](std::size_t index) {
+        return values[index];
+    }
+
+    constexpr const T& operator[](std::size_t index) const {
+        return values[index];
+    }
+};
+
+enum class ValidationError : std::uint8_t {
+    none,
+    unnamed_state,
+    duplicate_state,
+    unknown_type,
+    typed_parallel_state,
+    typed_compound_state,
+    typed_state_with_transitions,
+    history_outside_compound,
+    unknown_initial,
+    initial_not_child,
+    memory_targets_itself,
+    unknown_memory,
+    memory_not_sibling,
+    unknown_target
+};
+
+constexpr const char* describe(ValidationError error) {
+    switch (error) {
+        case ValidationError::none: return "Valid statechart";
+        case ValidationError::unnamed_state: return "State must have a name";
+        case ValidationError::duplicate_state: return "State already exists";
+        case ValidationError::unknown_type: return "State type is not one of 'final', 'shallow history', or 'deep history'";
+        case ValidationError::typed_parallel_state: return "Parallel state cannot also have a type";
+        case ValidationError::typed_compound_state: return "Compound state cannot also have a type";
+        case ValidationError::typed_state_with_transitions: return "State cannot have a type and also have transitions";
+        case ValidationError::history_outside_compound: return "History state must be the child of a compound state";
+        case ValidationError::unknown_initial: return "Initial state does not exist";
+        case ValidationError::initial_not_child: return "Initial state must be a child state";
+        case ValidationError::memory_targets_itself: return "Initial memory cannot target itself";
+        case ValidationError::unknown_memory: return "Initial memory does not exist";
+        case ValidationError::memory_not_sibling: return "Initial memory must be a parent's child";
+        case ValidationError::unknown_target: return "Unknown target state";
+    }
+    return "Invalid statechart";
+}
+
+struct StaticState {
+    Name name = {};
+    state_index parent = no_state;
+    StateKind kind = StateKind::basic;
+    // Initial state of a compound state, or initial memory of a history state.
+    Name initial_name = {};
+    state_index initial = no_state;
+    entryexit_fn on_entry = nullptr;
+    entryexit_fn on_exit = nullptr;
+
+    std::uint16_t depth = 0;
+    std::uint16_t rank = 0;
+    state_index subtree_end = 0;
+};
+
+struct StaticTransition {
+    state_index source = no_state;
+    Name target_name = {};
+    state_index target = no_state;
+    Name event_name = {};
+    event_index event = no_event;
+    guard_fn guard = nullptr;
+    action_fn action = nullptr;
+    std::int32_t priority = 0;
+
+    // Ancestor-or-self of the source just below the LCA, and depth of the LCA (0 if there is none).
+    state_index exit_root = no_state;
+    std::uint16_t lca_depth = 0;
+
+    constexpr bool is_internal() const {
+        return target_name.empty();
+    }
+
+    constexpr bool is_eventless() const {
+        return event_name.empty();
+    }
+};
+
+// Read-only tables of a statechart with S states and T transitions, built and checked in constant expressions.
+// States are numbered in depth-first pre-order from the root, transitions in the order of the dynamic builder.
+template <std::size_t S, std::size_t T>
+struct StaticStateChart {
+    static constexpr std::size_t state_count = S;
+    static constexpr std::size_t transition_count = T;
+
+    Name name = {};
+    Name description = {};
+    FixedArray<StaticState, S> states = {};
+    FixedArray<StaticTransition, T> transitions = {};
+    FixedArray<Name, T> events = {};
+    std::size_t event_count = 0;
+    ValidationError error = ValidationError::none;
+
+    // Candidate transitions per event in selection order, eventless ones last (at index event_count).
+    FixedArray<transition_index, T> dispatch = {};
+    FixedArray<std::uint16_t, T + 2> dispatch_offsets = {};
+    // Children of each state ordered by name.
+    FixedArray<state_index, S> children = {};
+    FixedArray<std::uint16_t, S + 1> children_offsets = {};
+    // States by depth (deepest first) then name, the order in which leaves are stabilized.
+    FixedArray<state_index, S> stabilization_order = {};
+    // States by depth (shallowest first) then name, the order in which history memory is restored.
+    FixedArray<state_index, S> restoration_order = {};
+
+    std::size_t added_states = 0;
+    std::size_t added_transitions = 0;
+
+    constexpr state_index id_for(Name state) const {
+        for (std::size_t id = 0; id < S; ++id) {
+            if (states[id].name == state) {
+                return static_cast<state_index>(id);
+            }
+        }
+        return no_state;
+    }
+
+    // Event index for the name, no_event if no transition is triggered by it.
+    constexpr event_index event_for(Name event) const {
+        for (std::size_t id = 0; id < event_count; ++id) {
+            if (events[id] == event) {
+                return static_cast<event_index>(id);
+            }
+        }
+        return no_event;
+    }
+
+    constexpr bool is_descendant(state_index id, state_index ancestor) const {
+        return ancestor < id and id < states[ancestor].subtree_end;
+    }
+
+    constexpr ValidationError check() const {
+        return error;
+    }
+
+    // True for a valid statechart, throws otherwise; use as static_assert(statechart.validate(), "...").
+    constexpr bool validate() const {
+        return error == ValidationError::none ? true : throw statechart_error(describe(error));
+    }
+
+    constexpr state_index add_state(state_index parent) {
+        auto id = static_cast<state_index>(added_states++);
+        states[id].parent = parent;
+        return id;
+    }
+
+    constexpr void add_transition(state_index source, StaticTransition transition) {
+        transition.source = source;
+        transitions[added_transitions++] = transition;
+    }
+
+    constexpr void fail(ValidationError failure) {
+        if (error == ValidationError::none) {
+            error = failure;
+        }
+    }
+
+    // Resolves names and precomputes the indices used by the interpreter.
+    constexpr void compile() {
+        compile_states();
+        compile_transitions();
+        compile_orders();
+    }
+
+private:
+    constexpr void compile_states() {
+        for (std::size_t id = 0; id < S; ++id) {
+            auto& state = states[id];
+            if (state.name.empty()) {
+                fail(ValidationError::unnamed_state);
+            }
+            for (std::size_t other = 0; other < id; ++other) {
+                if (states[other].name == state.name) {
+                    fail(ValidationError::duplicate_state);
+                }
+            }
+
+            state.depth = state.parent == no_state ? 1 : states[state.parent].depth + 1;
+            for (std::size_t other = 0; other < S; ++other) {
+                if (states[other].name < state.name) {
+                    ++state.rank;
+                }
+            }
+        }
+
+        // With pre-order ids, the descendants of a state are exactly the ids in (id, subtree_end).
+        for (auto id = S; id-- > 0;) {
+            auto& state = states[id];
+            if (state.subtree_end < id + 1) {
+                state.subtree_end = static_cast<state_index>(id + 1);
+            }
+            if (state.parent != no_state and states[state.parent].subtree_end < state.subtree_end) {
+                states[state.parent].subtree_end = state.subtree_end;
+            }
+        }
+
+        for (std::size_t id = 0; id < S; ++id) {
+            auto& state = states[id];
+            auto is_history = state.kind == StateKind::shallow_history or state.kind == StateKind::deep_history;
+            if (is_history and (state.parent == no_state or states[state.parent].kind != StateKind::compound)) {
+                fail(ValidationError::history_outside_compound);
+            }
+
+            if (state.kind == StateKind::compound) {
+                state.initial = id_for(state.initial_name);
+                if (state.initial == no_state) {
+                    fail(ValidationError::unknown_initial);
+                } else if (states[state.initial].parent != id) {
+                    fail(ValidationError::initial_not_child);
+                    state.initial = no_state;
+                }
+            } else if (is_history and !state.initial_name.empty()) {
+                state.initial = id_for(state.initial_name);
+                if (state.initial == id) {
+                    fail(ValidationError::memory_targets_itself);
+                    state.initial = no_state;
+                } else if (state.initial == no_state) {
+                    fail(ValidationError::unknown_memory);
+                } else if (states[state.initial].parent != state.parent) {
+                    fail(ValidationError::memory_not_sibling);
+                    state.initial = no_state;
+                }
+            }
+        }
+    }
+
+    constexpr void compile_transitions() {
+        for (std::size_t id = 0; id < T; ++id) {
+            auto& transition = transitions[id];
+            auto kind = states[transition.source].kind;
+            if (kind == StateKind::final or kind == StateKind::shallow_history or kind == StateKind::deep_history) {
+                fail(ValidationError::typed_state_with_transitions);
+            }
+
+            if (!transition.is_eventless()) {
+                transition.event = event_for(transition.event_name);
+                if (transition.event == no_event) {
+                    transition.event = static_cast<event_index>(event_count);
+                    events[event_count++] = transition.event_name;
+                }
+            }
+
+            if (transition.is_internal()) {
+                continue;
+            }
+
+            transition.target = id_for(transition.target_name);
+            if (transition.target == no_state) {
+                fail(ValidationError::unknown_target);
+                continue;
+            }
+
+            // Deepest common proper ancestor of the source and the target.
+            auto first = states[transition.source].parent;
+            auto second = states[transition.target].parent;
+            if (first != no_state and second != no_state) {
+                while (states[first].depth > states[second].depth) {
+                    first = states[first].parent;
+                }
+                while (states[second].depth > states[first].depth) {
+                    second = states[second].parent;
+                }
+                while (first != second) {
+                    first = states[first].parent;
+                    second = states[second].parent;
+                }
+                transition.lca_depth = states[first].depth;
+            }
+
+            transition.exit_root = transition.source;
+            while (states[transition.exit_root].depth > transition.lca_depth + 1) {
+                transition.exit_root = states[transition.exit_root].parent;
+            }
+        }
+    }
+
+    constexpr bool precedes(transition_index first, transition_index second) const {
+        auto& t1 = transitions[first];
+        auto& t2 = transitions[second];
+        auto e1 = t1.is_eventless() ? event_count : t1.event;
+        auto e2 = t2.is_eventless() ? event_count : t2.event;
+        if (e1 != e2) {
+            return e1 < e2;
+        }
+        if (t1.source != t2.source) {
+            auto& s1 = states[t1.source];
+            auto& s2 = states[t2.source];
+            return s1.depth != s2.depth ? s1.depth > s2.depth : s1.rank < s2.rank;
+        }
+        if (t1.priority != t2.priority) {
+            return t1.priority > t2.priority;
+        }
+        return first < second;
+    }
+
+    enum class Order {
+        by_name,
+        deepest_first,
+        shallowest_first
+    };
+
+    // Lambdas cannot appear in constant expressions before C++17, hence the explicit orders.
+    constexpr bool less(Order order, state_index first, state_index second) const {
+        auto& s1 = states[first];
+        auto& s2 = states[second];
+        if (order == Order::by_name or s1.depth == s2.depth) {
+            return s1.rank < s2.rank;
+        }
+        return order == Order::deepest_first ? s1.depth > s2.depth : s1.depth < s2.depth;
+    }
+
+    constexpr void insertion_sort(FixedArray<state_index, S>& values, std::size_t first, std::size_t last, Order order) const {
+        for (auto i = first + 1; i < last; ++i) {
+            auto value = values[i];
+            auto j = i;
+            for (; j > first and less(order, value, values[j - 1]); --j) {
+                values[j] = values[j - 1];
+            }
+            values[j] = value;
+        }
+    }
+
+    constexpr void compile_orders() {
+        for (std::size_t id = 0; id < T; ++id) {
+            dispatch[id] = static_cast<transition_index>(id);
+        }
+        for (std::size_t i = 1; i < T; ++i) {
+            auto value = dispatch[i];
+            auto j = i;
+            for (; j > 0 and precedes(value, dispatch[j - 1]); --j) {
+                dispatch[j] = dispatch[j - 1];
+            }
+            dispatch[j] = value;
+        }
+
+        std::size_t position = 0;
+        for (std::size_t event = 0; event <= event_count; ++event) {
+            dispatch_offsets[event] = static_cast<std::uint16_t>(position);
+            while (position < T and (transitions[dispatch[position]].is_eventless() ? event_count : transitions[dispatch[position]].event) == event) {
+                ++position;
+            }
+        }
+        dispatch_offsets[event_count + 1] = static_cast<std::uint16_t>(position);
+
+        // Children are contiguous per parent once sorted by parent, and by name within a parent.
+        std::size_t count = 0;
+        for (std::size_t id = 0; id < S; ++id) {
+            children_offsets[id] = static_cast<std::uint16_t>(count);
+            for (std::size_t child = id + 1; child < states[id].subtree_end; ++child) {
+                if (states[child].parent == id) {
+                    children[count++] = static_cast<state_index>(child);
+                }
+            }
+            insertion_sort(children, children_offsets[id], count, Order::by_name);
+        }
+        children_offsets[S] = static_cast<std::uint16_t>(count);
+
+        for (std::size_t id = 0; id < S; ++id) {
+            stabilization_order[id] = static_cast<state_index>(id);
+            restoration_order[id] = static_cast<state_index>(id);
+        }
+        insertion_sort(stabilization_order, 0, S, Order::deepest_first);
+        insertion_sort(restoration_order, 0, S, Order::shallowest_first);
+    }
+};
+
+}  // namespace compile_time
+}  // namespace sismicpp
+
+#endif  // INCLUDE
@@ -0,0 +1,146 @@
+#ifndef INCLUDE_SISMICPP_INTERPRETER_CACHE
+#define INCLUDE_SISMICPP_INTERPRETER_CACHE
+
+#include "utilities.h"
+#include "model/compiled.h"
+#include "model/symbols.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sismicpp {
+
+// Bounded, least-recently-used memo of the transition steps computed for a (configuration, event) pair.
+// Only selections that evaluated no guard are stored, since they are a function of that pair alone.
+// A cache belongs to one compiled statechart and can be shared by all of its interpreters.
+struct MacroStepCache {
+    struct Step {
+        const CompiledTransition* transition = nullptr;
+        std::vector<state_id> entered_states = {};
+        std::vector<state_id> exited_states = {};
+    };
+
+    using Steps = std::vector<Step>;
+
+private:
+    struct Key {
+        std::vector<Bitset::word_type> configuration = {};
+        symbol_id event = no_symbol;
+        bool has_event = false;
+
+        bool operator==(const Key& other) const {
+            return event == other.event and has_event == other.has_event and configuration == other.configuration;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            std::uint64_t hash = 1469598103934665603ull;
+            auto combine = [&hash] (std::uint64_t value) {
+                hash ^= value;
+                hash *= 1099511628211ull;
+            };
+            for (auto&& word : key.configuration) {
+                combine(word);
+            }
+            combine(key.event);
+            combine(key.has_event);
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    using Entry = std::pair<Key, std::shared_ptr<const Steps>>;
+
+    std::shared_ptr<const CompiledStateChart> statechart;
+    size_t capacity;
+
+    mutable std::mutex mutex = {};
+    std::list<Entry> entries = {};
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index = {};
+    // Reused by find(), under the lock, so that lookups do not allocate.
+    Key probe = {};
+    size_t hits = 0;
+    size_t misses = 0;
+
+public:
+    explicit MacroStepCache(std::shared_ptr<const CompiledStateChart> statechart, size_t capacity = 1024) :
+    statechart(std::move(statechart)),
+    capacity(capacity) {}
+
+    const CompiledStateChart& get_statechart() const {
+        return *statechart;
+    }
+
+    // Steps memoized for the pair, nullptr on a miss. `has_event` tells an unknown event from no event at all.
+    std::shared_ptr<const Steps> find(const Bitset& configuration, symbol_id event, bool has_event) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        probe.configuration.assign(configuration.get_words().begin(), configuration.get_words().end());
+        probe.event = event;
+        probe.has_event = has_event;
+        auto it = index.find(probe);
+        if (it == index.end()) {
+            ++misses;
+            return nullptr;
+        }
+
+        ++hits;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->second;
+    }
+
+    void insert(const Bitset& configuration, symbol_id event, bool has_event, Steps steps) {
+        if (capacity == 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        Key key{configuration.get_words(), event, has_event};
+        if (index.find(key) != index.end()) {
+            return;
+        }
+
+        if (entries.size() >= capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+
+        entries.emplace_front(key, std::make_shared<const Steps>(std::move(steps)));
+        index.emplace(std::move(key), entries.begin());
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        index.clear();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    size_t get_capacity() const {
+        return capacity;
+    }
+
+    size_t get_hits() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return hits;
+    }
+
+    size_t get_misses() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return misses;
+    }
+};
+
+}  // namespace sismicpp
+
+#endif  // INCLUDE
@@ -5,12 +5,25 @@
 #include "model/steps.h"
 #include "model/elements.h"
 #include "model/statechart.h"
+#include "model/compiled.h"
 #include "model/events.h"
+#include "model/pool.h"
+#include "interpreter/cache.h"
+#include "interpreter/queue.h"
 #include "clock/clock.h"
 #include "code/attachable.h"
 #include "code/evaluator.h"
 #include "code/cpp.h"
-
+#include "exceptions.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <mutex>
 #include <string>
 #include <memory>
 #include <utility>
@@ -20,112 +33,290 @@
 
 namespace sismicpp {
 
-struct Interpreter : Observable {
+struct Interpreter : Observable, ActiveStatesProvider {
 private:
-    const StateChart statechart;
+    // Micro step expressed in compiled ids, turned into a MicroStep once applied.
+    struct Step {
+        std::shared_ptr<const Event> event = nullptr;
+        const CompiledTransition* transition = nullptr;
+        std::vector<state_id> entered_states = {};
+        std::vector<state_id> exited_states = {};
+    };
+
+    std::shared_ptr<const CompiledStateChart> statechart;
 
     bool initialized = false;
-    std::map<std::string, std::vector<std::string>> memory = {};
-    std::vector<std::string> configuration = {};
-    std::vector<std::pair<double, std::shared_ptr<const InternalEvent>>> internal_queue = {};
-    std::vector<std::pair<double, std::shared_ptr<const Event>>> external_queue = {};
-    std::vector<Attachable*> listeners = {};
+    std::vector<std::vector<state_id>> memory = {};
+    std::vector<bool> has_memory = {};
+    Bitset configuration = {};
+    EventQueue internal_queue = {};
+    EventQueue external_queue = {};
+    ListenerSet listeners = {};
+    // Queued, sent and meta-events are allocated from the pool.
+    EventPool::Owner event_pool = EventPool::create();
 
     std::unique_ptr<Evaluator> evaluator;
+    std::shared_ptr<MacroStepCache> cache = nullptr;
+
+    // Scratch storage of execute_once(), reused by every macro step.
+    std::vector<Step> step_buffer = {};
+    size_t step_count = 0;
+    Step stabilization_step = {};
+    std::vector<const CompiledTransition*> selected_transitions = {};
+    std::vector<state_id> selected_sources = {};
+    std::vector<state_id> leaves = {};
+    std::vector<MicroStep> spare_micro_steps = {};
+    std::vector<std::string> spare_names = {};
+    // Events sent by the step a visitor is viewing.
+    std::vector<std::shared_ptr<const Event>> viewed_sent_events = {};
+    MetaEventSlots meta_event_slots = {};
+
+    // Events posted from other threads, until run() takes them.
+    std::mutex posted_mutex = {};
+    std::condition_variable posted_ready = {};
+    std::vector<std::shared_ptr<const Event>> posted_events = {};
+    std::atomic<bool> stop_requested{false};
 
 public:
     std::unique_ptr<Clock> clock = std::make_unique<SimulatedClock>();
-    
-    Interpreter(StateChart statechart, void* context) : 
+
+    Interpreter(std::shared_ptr<const CompiledStateChart> statechart, void* context) :
     statechart(std::move(statechart)),
-    evaluator(std::make_unique<CppEvaluator>(*this, context)) {
-        evaluator->execute_statechart(statechart);
+    memory(this->statechart->size()),
+    has_memory(this->statechart->size(), false),
+    configuration(this->statechart->size()),
+    evaluator(std::make_unique<CppEvaluator>(*this, *this, context, event_pool.get())) {
+        evaluator->execute_statechart(this->statechart->get_statechart());
     }
 
+    Interpreter(StateChart statechart, void* context) :
+    Interpreter(std::make_shared<const CompiledStateChart>(std::move(statechart)), context) {}
+
     explicit Interpreter(StateChart statechart) : Interpreter(std::move(statechart), nullptr) {}
 
+    const CompiledStateChart& get_statechart() const {
+        return *statechart;
+    }
+
     std::vector<std::string> get_configuration() const {
-        return configuration;
+        std::vector<std::string> ret;
+        for (auto&& id : configuration.ones()) {
+            ret.push_back(statechart->name_for(static_cast<state_id>(id)));
+        }
+        return ret;
+    }
+
+    // Ids of the active states in pre-order, without copying the configuration.
+    Bitset::View get_active_states() const {
+        return configuration.ones();
+    }
+
+    bool is_active(state_id id) const {
+        return configuration.test(id);
+    }
+
+    bool is_active(const std::string& name) const override {
+        auto id = statechart->id_for(name);
+        return id != no_state and configuration.test(id);
     }
 
     bool is_in_final() const {
-        return initialized and configuration.empty();
+        return initialized and !configuration.any();
+    }
+
+    // Memoize guard-free transition selections in the cache, which must belong to the same compiled statechart.
+    void set_cache(std::shared_ptr<MacroStepCache> cache) {
+        if (cache and &cache->get_statechart() != statechart.get()) {
+            throw sismic_error("Cache does not belong to statechart " + statechart->get_statechart().name);
+        }
+        this->cache = std::move(cache);
+    }
+
+    // Replaces the CppEvaluator, which is given the statechart through execute_statechart().
+    void set_evaluator(std::unique_ptr<Evaluator> evaluator) {
+        this->evaluator = std::move(evaluator);
+        this->evaluator->execute_statechart(statechart->get_statechart());
+    }
+
+    const std::shared_ptr<MacroStepCache>& get_cache() const {
+        return cache;
+    }
+
+    // Also allocates events to queue, through make_pooled().
+    EventPool& get_event_pool() const {
+        return *event_pool;
     }
 
+    // Meta-events are only built for the kinds the attached listeners subscribed to.
     void attach(Attachable* listener) override {
-        listeners.push_back(listener);
+        listeners.attach(listener);
     }
 
     void detach(Attachable* listener) override {
-        listeners.erase(std::find(listeners.begin(), listeners.end(), listener));
+        listeners.detach(listener);
     }
 
     Interpreter& queue(std::shared_ptr<const Event> event) {
-        double time = clock->get_time() + event->delay;
-
-        auto insert = [time] (auto& queue, auto event) {
-            std::pair<double, decltype(event)> pair = {time, event};
-
-            queue.insert(
-                std::upper_bound(
-                    queue.begin(), queue.end(), pair, [] (auto& p1, auto& p2) -> bool {
-                        if (p1.first != p2.first) {
-                            return p1.first < p2.first;
-                        } else {
-                            return !p1.second->is_internal_event() < !p2.second->is_internal_event();
-                        }
-                    }
-                ),
-                {time, std::move(event)}
-            );
-        };
+        auto handle = handle_for(*event);
+        push_event(std::move(event), std::move(handle));
+        return *this;
+    }
 
-        if (event->is_internal_event()) {
-            insert(
-                internal_queue,
-                std::shared_ptr<const InternalEvent>(std::dynamic_pointer_cast<const InternalEvent>(event))
-            );
-        } else {
-            insert(external_queue, std::move(event));
+    Interpreter& queue(std::string name) {
+        queue(make_pooled<Event>(event_pool.get(), std::move(name)));
+        return *this;
+    }
+
+    // Same as queue(), with a handle to cancel the event. Sent events keep the handle returned by send().
+    EventHandle schedule(std::shared_ptr<const Event> event) {
+        auto handle = handle_for(*event);
+        if (!handle.valid()) {
+            handle = EventHandle::create(event_pool.get());
         }
+        push_event(std::move(event), handle);
+        return handle;
+    }
 
-        return *this;
+    EventHandle schedule(std::string name) {
+        return schedule(make_pooled<Event>(event_pool.get(), std::move(name)));
     }
 
-    Interpreter& queue(std::string name) {
-        queue(std::make_unique<Event>(std::move(name)));
+    // Queues a range of events, names, or (name, data) pairs, with a single read of the clock.
+    template <typename Events>
+    Interpreter& queue_many(const Events& events) {
+        queue_batch(events);
         return *this;
     }
 
+    // Queues the batch, then executes until the external events of the batch that are due are consumed.
+    // External events queued before the batch come first, and internal events are processed as they are sent,
+    // but events queued after the batch are left for a later execution.
+    template <typename Events>
+    BatchResult execute_batch(const Events& events) {
+        auto batch_end = queue_batch(events);
+
+        BatchResult ret;
+        while (true) {
+            internal_queue.advance(clock->get_time());
+            external_queue.advance(clock->get_time());
+            auto queued = select_event();
+            if (queued and !queued->event->is_internal_event() and queued->order >= batch_end) {
+                break;
+            }
+
+            auto macro_step = execute_once();
+            if (!macro_step) {
+                break;
+            }
+
+            if (!macro_step->steps.empty() and macro_step->steps.front().event) {
+                ++ret.consumed_events;
+            }
+            for (auto&& step : macro_step->steps) {
+                ret.processed_transitions += step.transition ? 1 : 0;
+                ret.sent_events += step.sent_events.size();
+            }
+            ret.macro_steps.push_back(std::move(*macro_step));
+        }
+
+        return ret;
+    }
+
 private:
+    std::shared_ptr<const Event> make_event(std::shared_ptr<const Event> event) const {
+        return event;
+    }
+
+    std::shared_ptr<const Event> make_event(std::string name) const {
+        return make_pooled<Event>(event_pool.get(), std::move(name));
+    }
+
+    std::shared_ptr<const Event> make_event(const std::pair<std::string, void*>& name_and_data) const {
+        auto event = make_pooled<Event>(event_pool.get(), name_and_data.first);
+        event->data = name_and_data.second;
+        return event;
+    }
+
+    // Returns the insertion order that follows the external events of the batch.
+    template <typename Events>
+    std::uint64_t queue_batch(const Events& events) {
+        auto time = clock->get_time();
+        internal_queue.advance(time);
+        external_queue.advance(time);
+        external_queue.reserve(static_cast<size_t>(std::distance(std::begin(events), std::end(events))));
+
+        std::uint64_t batch_end = 0;
+        for (auto&& element : events) {
+            auto event = make_event(element);
+            QueuedEvent queued{
+                .time=time + event->delay,
+                .symbol=statechart->symbol_for(event->name),
+                .event=event,
+                .handle=handle_for(*event)
+            };
+            if (event->is_internal_event()) {
+                internal_queue.push(std::move(queued));
+            } else {
+                batch_end = external_queue.push(std::move(queued)) + 1;
+            }
+        }
+        return batch_end;
+    }
+
+    void push_event(std::shared_ptr<const Event> event, EventHandle handle) {
+        QueuedEvent queued{
+            .time=clock->get_time() + event->delay,
+            .symbol=statechart->symbol_for(event->name),
+            .event=std::move(event),
+            .handle=std::move(handle)
+        };
+
+        auto& queue = queued.event->is_internal_event() ? internal_queue : external_queue;
+        queue.advance(clock->get_time());
+        queue.push(std::move(queued));
+    }
+
     void raise_event(std::shared_ptr<const MetaEvent> event) {
-        for (auto&& listener : listeners) {
-            listener->operator()(event);
+        listeners.notify(event);
+    }
+
+    // Fills and raises a meta-event, if a listener subscribed to its kind.
+    template <typename Fill>
+    void raise_meta_event(MetaEventKind kind, Fill fill) {
+        if (!listeners.wants(kind)) {
+            return;
         }
+        auto event = meta_event_slots.acquire(event_pool.get(), kind, clock->get_time(), statechart->get_symbols());
+        fill(*event);
+        listeners.notify(event);
     }
 
     void raise_event(std::shared_ptr<const InternalEvent> event) {
-        MetaEvent event_sent("event sent", clock->get_time());
-        event_sent.event = event;
-        raise_event(std::make_shared<const MetaEvent>(event_sent));
+        raise_meta_event(MetaEventKind::event_sent, [&] (MetaEvent& event_sent) {
+            event_sent.event = event;
+        });
         queue(std::move(event));
     }
 
+    // Evaluators may return any Event, so only the kind tells whether the downcast is safe.
     void raise_event(std::shared_ptr<const Event> event) {
-        if (event->is_internal_event()) {
-            raise_event(std::shared_ptr<const InternalEvent>(std::dynamic_pointer_cast<const InternalEvent>(event)));
-        } else {
-            raise_event(std::shared_ptr<const MetaEvent>(std::dynamic_pointer_cast<const MetaEvent>(event)));
+        switch (event->get_kind()) {
+            case EventKind::internal:
+                raise_event(std::static_pointer_cast<const InternalEvent>(std::move(event)));
+                break;
+            case EventKind::meta:
+                raise_event(std::static_pointer_cast<const MetaEvent>(std::move(event)));
+                break;
+            case EventKind::external:
+                throw sismic_error("Event " + event->name + " was sent without send() or notify()");
         }
     }
 
     auto select_event_and_consume() {
         auto select_from_queue = [&] (auto& queue) -> std::shared_ptr<const Event> {
             if (!queue.empty()) {
-                if (queue.front().first <= clock->get_time()) {
-                    auto time_event = std::move(queue.front());
-                    queue.erase(queue.begin());
-                    return std::move(time_event.second);
+                if (queue.front().time <= clock->get_time()) {
+                    return queue.pop().event;
                 }
             }
             return nullptr;
@@ -139,385 +330,487 @@ private:
         return event;
     }
 
-    auto select_event() const {
-        auto select_from_queue = [&] (auto& queue) -> std::shared_ptr<const Event> {
+    const QueuedEvent* select_event() const {
+        auto select_from_queue = [&] (auto& queue) -> const QueuedEvent* {
             if (!queue.empty()) {
-                if (queue.front().first <= clock->get_time()) {
-                    return queue.front().second;
+                if (queue.front().time <= clock->get_time()) {
+                    return &queue.front();
                 }
             }
             return nullptr;
         };
 
-        auto event = select_from_queue(internal_queue);
-        if (!event) {
-            event = select_from_queue(external_queue);
+        auto queued = select_from_queue(internal_queue);
+        if (!queued) {
+            queued = select_from_queue(external_queue);
         }
 
-        return event;
+        return queued;
     }
 
-    std::vector<const Transition*> select_transitions(const Event* event, 
-                                                const std::vector<std::string>& states,
-                                                bool eventless_first,
-                                                bool inner_first) const {
-        std::vector<const Transition*> selected_transitions;
-        std::vector<const Transition*> considered_transitions;
-        std::map<std::string, int> state_depth_cache;
-
-        for (auto& transition : statechart.transitions) {
-            if (std::find(states.begin(), states.end(), transition.source) != states.end()) {
-                if (transition.event == "" or (event and transition.event == event->name)) {
-                    if (state_depth_cache.find(transition.source) == state_depth_cache.end()) {
-                        state_depth_cache[transition.source] = statechart.depth_for(transition.source);
-                    }
-
-                    considered_transitions.push_back(&transition);
-                }
-            }
-        }
-
-        std::vector<std::string> ignored_states;
-
-        for (auto&& has_event_transitions_pair : sorted_groupby(considered_transitions, [] (auto transition) -> bool {
-            return transition->event != "";
-        }, !eventless_first)) {
-            if (!selected_transitions.empty()) {
-                break;
-            }
-
-            const Event* exposed_event = has_event_transitions_pair.first ? event : nullptr;
-
-            for (auto&& depth_transition_pair : sorted_groupby(has_event_transitions_pair.second, [&state_depth_cache] (auto transition) {
-                return state_depth_cache[transition->source];
-            }, inner_first)) {
-                for (auto&& source_transitions_pair : sorted_groupby(depth_transition_pair.second, [] (auto transition) {
-                    return transition->source;
-                }, false)) {
-                    if (std::find(ignored_states.begin(), ignored_states.end(), source_transitions_pair.first) != ignored_states.end()) {
-                        continue;
-                    }
-
-                    bool has_found_transitions = false;
+    // Eventless transitions are considered first, then inner-first: deeper sources are preferred,
+    // ties are broken by source name, and only the highest priority group with an enabled guard is kept.
+    // Candidates come from the dispatch index, already in selection order, so the selected
+    // transitions are ordered by source depth (deepest first) and source name.
+    // TODO: add throw if there are confliciting transitions or indeterminacies.
+    // Events unknown to the statechart resolve to no_symbol, which has no candidates.
+    // Sets evaluated_guards when the selection depended on at least one guard.
+    const std::vector<const CompiledTransition*>& select_transitions(const Event* event, symbol_id symbol, bool& evaluated_guards) {
+        selected_transitions.clear();
+        selected_sources.clear();
+
+        auto select_from = [&] (Range<transition_id> candidates, const Event* exposed_event) {
+            auto it = candidates.begin();
+            while (it != candidates.end()) {
+                auto source = statechart->transition_for(*it).source;
+                auto source_end = std::find_if(it, candidates.end(), [&] (auto id) {
+                    return statechart->transition_for(id).source != source;
+                });
 
-                    for (auto&& priority_transitions_pair : sorted_groupby(source_transitions_pair.second, [] (auto transition) {
-                        return transition->priority;
-                    }, true)) {
-                        for (auto&& transition : priority_transitions_pair.second) {
+                // Sources that are a selected source or one of its ancestors are ignored (inner-first).
+                if (is_active(source) and std::none_of(selected_sources.begin(), selected_sources.end(), [&] (auto selected_source) {
+                    return source == selected_source or statechart->is_descendant(selected_source, source);
+                })) {
+                    auto priority_it = it;
+                    while (priority_it != source_end) {
+                        auto priority = statechart->transition_for(*priority_it).transition->priority;
+                        auto priority_end = std::find_if(priority_it, source_end, [&] (auto id) {
+                            return statechart->transition_for(id).transition->priority != priority;
+                        });
+
+                        bool has_found_transitions = false;
+                        for (; priority_it != priority_end; ++priority_it) {
+                            auto& compiled_transition = statechart->transition_for(*priority_it);
+                            auto transition = compiled_transition.transition;
+                            evaluated_guards = evaluated_guards or transition->guard;
                             if (!transition->guard or evaluator->evaluate_guard(*transition, exposed_event)) {
-                                selected_transitions.push_back(transition);
+                                selected_transitions.push_back(&compiled_transition);
                                 has_found_transitions = true;
                             }
                         }
 
                         if (has_found_transitions) {
-                            if (inner_first) {
-                                for (auto&& state : statechart.ancestors_for(source_transitions_pair.first)) {
-                                    ignored_states.push_back(state);
-                                }
-                            } else {
-                                for (auto&& state : statechart.descendants_for(source_transitions_pair.first)) {
-                                    ignored_states.push_back(state);
-                                }
-                            }
-                            ignored_states.push_back(source_transitions_pair.first);
+                            selected_sources.push_back(source);
                             break;
                         }
                     }
                 }
+
+                it = source_end;
             }
+        };
+
+        select_from(statechart->eventless_transitions(), nullptr);
+        if (selected_transitions.empty() and event) {
+            select_from(statechart->transitions_for_event(symbol), event);
         }
 
         return selected_transitions;
     }
 
-    std::vector<const Transition*> sort_transitions(std::vector<const Transition*> transitions) const {
-        // TODO: add throw if there are confliciting transitions or indeterminacies.
-        std::sort(transitions.begin(), transitions.end(), [&] (auto t1, auto t2) {
-            auto d1 = statechart.depth_for(t1->source);
-            auto d2 = statechart.depth_for(t2->source);
-            if (d1 != d2) { 
-                return d1 > d2;
-            } else {
-                return t1->source < t2->source;
-            }
-        });
-        return transitions;
+    // Next step of the buffer, cleared but with the storage of a previous macro step.
+    Step& next_step() {
+        if (step_count == step_buffer.size()) {
+            step_buffer.emplace_back();
+        }
+        auto& step = step_buffer[step_count++];
+        step.event = nullptr;
+        step.transition = nullptr;
+        step.entered_states.clear();
+        step.exited_states.clear();
+        return step;
     }
 
-    std::vector<MicroStep> create_steps(std::shared_ptr<const Event> event, std::vector<const Transition*> transitions) const {
-        std::vector<MicroStep> returned_steps;
-
+    void create_steps(const std::shared_ptr<const Event>& event, const std::vector<const CompiledTransition*>& transitions) {
         for (auto&& transition : transitions) {
-            if (transition->target == "") {
-                returned_steps.push_back({
-                    .event=event,
-                    .transition=transition
-                });
+            auto& step = next_step();
+            step.event = event;
+            step.transition = transition;
+            if (transition->is_internal()) {
                 continue;
             }
 
-            auto lca = statechart.least_common_ancestor(transition->source, transition->target);
-            auto from_ancestors = statechart.ancestors_for(transition->source);
-            auto to_ancestors = statechart.ancestors_for(transition->target);
-
-            std::vector<std::string> exited_states;
-
-            auto last_before_lca = transition->source;
-            for (auto&& state : from_ancestors) {
-                if (state == lca) {
-                    break;
-                }
-                last_before_lca = state;
+            // The active part of the exit scope is exited deepest first, and in reverse document order within a level.
+            auto exit_root = transition->exit_root;
+            auto descendants = statechart->descendants_for(exit_root);
+            auto& exited_states = step.exited_states;
+            for (auto&& state : configuration.ones(descendants.first, descendants.last)) {
+                exited_states.push_back(static_cast<state_id>(state));
             }
+            std::sort(exited_states.begin(), exited_states.end(), [&] (state_id s1, state_id s2) {
+                auto d1 = statechart->depth_for(s1);
+                auto d2 = statechart->depth_for(s2);
+                return d1 != d2 ? d1 > d2 : s1 > s2;
+            });
 
-            auto descendants = statechart.descendants_for(last_before_lca);
-            std::reverse(descendants.begin(), descendants.end());
-            for (auto&& descendant : descendants) {
-                if (std::find(configuration.begin(), configuration.end(), descendant) != configuration.end()) {
-                    exited_states.push_back(std::move(descendant));
-                }
+            if (is_active(exit_root)) {
+                exited_states.push_back(exit_root);
             }
 
-            if (std::find(configuration.begin(), configuration.end(), last_before_lca) != configuration.end()) {
-                exited_states.push_back(std::move(last_before_lca));
-            }
+            step.entered_states.assign(transition->entry_path.begin(), transition->entry_path.end());
+        }
+    }
+
+    void compute_steps_initialized() {
+        auto queued = select_event();
+        auto event = queued ? queued->event : nullptr;
+        auto symbol = queued ? queued->symbol : no_symbol;
 
-            std::vector<std::string> entered_states{transition->target};
-            for (auto&& state : to_ancestors) {
-                if (state == lca) {
-                    break;
+        if (cache) {
+            auto cached = cache->find(configuration, symbol, event != nullptr);
+            if (cached) {
+                if (cached->empty() and event) {
+                    next_step().event = event;
                 }
-                entered_states.insert(entered_states.begin(), std::move(state));
-            }
 
-            returned_steps.push_back({
-                .event=event,
-                .transition=transition,
-                .entered_states=std::move(entered_states),
-                .exited_states=std::move(exited_states)
-            });
+                for (auto&& cached_step : *cached) {
+                    auto& step = next_step();
+                    step.event = cached_step.transition->transition->is_eventless() ? nullptr : event;
+                    step.transition = cached_step.transition;
+                    step.entered_states.assign(cached_step.entered_states.begin(), cached_step.entered_states.end());
+                    step.exited_states.assign(cached_step.exited_states.begin(), cached_step.exited_states.end());
+                }
+                return;
+            }
         }
 
-        return returned_steps;
-    }
-
-    std::vector<MicroStep> compute_steps_initialized() const {
-        auto event = select_event();
-        auto transitions = select_transitions(event.get(), configuration, true, true);
+        bool evaluated_guards = false;
+        auto& transitions = select_transitions(event.get(), symbol, evaluated_guards);
 
         if (transitions.empty()) {
-            if (event == nullptr) {
-                return {};
-            } else {
-                return {{.event=event}};
+            if (event) {
+                next_step().event = event;
             }
+        } else {
+            create_steps(transitions[0]->transition->is_eventless() ? nullptr : event, transitions);
         }
 
-        transitions = sort_transitions(std::move(transitions));
-
-        event = transitions[0]->event == "" ? nullptr : event;
-
-        return create_steps(event, transitions);
+        if (cache and !evaluated_guards) {
+            MacroStepCache::Steps cached;
+            if (!transitions.empty()) {
+                cached.reserve(step_count);
+                for (size_t i = 0; i < step_count; ++i) {
+                    auto& step = step_buffer[i];
+                    cached.push_back({
+                        .transition=step.transition,
+                        .entered_states=step.entered_states,
+                        .exited_states=step.exited_states
+                    });
+                }
+            }
+            cache->insert(configuration, symbol, event != nullptr, std::move(cached));
+        }
     }
 
-    std::vector<MicroStep> compute_steps() {
+    // Fills the first step_count steps of the buffer.
+    void compute_steps() {
+        step_count = 0;
         if (!initialized) {
             initialized = true;
-            return {{.entered_states={statechart.get_root()}}};
+            next_step().entered_states.push_back(statechart->get_root());
         } else {
-            return compute_steps_initialized();
+            compute_steps_initialized();
         }
     }
 
-    std::unique_ptr<MicroStep> create_stabilization_step(const std::vector<std::string>& names) const {
-        auto leaves_names = statechart.leaf_for(names);
-        std::sort(leaves_names.begin(), leaves_names.end(), [&] (auto&& n1, auto&& n2) {
-            auto d1 = statechart.depth_for(n1);
-            auto d2 = statechart.depth_for(n2);
-            if (d1 != d2) {
-                return d1 > d2;
-            } else {
-                return n1 < n2;
+    // Compound and orthogonal leaves are completed with their whole default-entry closure in a single step,
+    // only history states need a step of their own since they depend on the recorded memory.
+    // Returns false if the configuration is stable.
+    bool create_stabilization_step(Step& step) {
+        step.event = nullptr;
+        step.transition = nullptr;
+        step.entered_states.clear();
+        step.exited_states.clear();
+
+        // In pre-order, an active state is a leaf unless the next active state lies in its subtree.
+        leaves.clear();
+        auto active = configuration.ones();
+        for (auto it = active.begin(); it != active.end();) {
+            auto state = static_cast<state_id>(*it);
+            ++it;
+            if (it == active.end() or !statechart->is_descendant(static_cast<state_id>(*it), state)) {
+                leaves.push_back(state);
             }
-        });
-        
-        for (auto&& leaf_name : leaves_names) {
-            auto& leaf = statechart.state_for(leaf_name);
-            if (leaf.is_final_state() and statechart.parent_for(leaf.name) == statechart.get_root()) {
-                return std::make_unique<MicroStep>(MicroStep{
-                    .exited_states={leaf.name, statechart.get_root()}
-                });
-            } else if (leaf.is_history_state()) {
-                if (memory.find(leaf.name) != memory.end()) {
-                    std::vector<std::string> states_to_enter = memory.at(leaf.name);
-                    std::sort(states_to_enter.begin(), states_to_enter.end(), [&] (auto&& s1, auto&& s2) {
-                        auto d1 = statechart.depth_for(s1);
-                        auto d2 = statechart.depth_for(s2);
-                        if (d1 != d2) {
-                            return d1 < d2;
-                        } else {
-                            return s1 < s2;
-                        }
-                    });
-                    return std::make_unique<MicroStep>(MicroStep{
-                        .entered_states=std::move(states_to_enter),
-                        .exited_states={leaf.name}
-                    });
+        }
+
+        auto by_depth = [&] (bool deepest_first) {
+            return [&, deepest_first] (state_id s1, state_id s2) {
+                auto d1 = statechart->depth_for(s1);
+                auto d2 = statechart->depth_for(s2);
+                if (d1 != d2) {
+                    return deepest_first ? d1 > d2 : d1 < d2;
                 } else {
-                    return std::make_unique<MicroStep>(MicroStep{
-                        .entered_states={static_cast<const HistoryState*>(&leaf)->memory},
-                        .exited_states={leaf.name}
-                    });
+                    return statechart->rank_for(s1) < statechart->rank_for(s2);
                 }
-            } else if (leaf.is_orthogonal_state()) {
-                auto children = statechart.children_for(leaf.name);
-                if (!children.empty()) {
-                    std::sort(children.begin(), children.end());
-                    return std::make_unique<MicroStep>(MicroStep{
-                        .entered_states=children
-                    });
+            };
+        };
+
+        std::sort(leaves.begin(), leaves.end(), by_depth(true));
+
+        auto root = statechart->get_root();
+        for (auto&& leaf : leaves) {
+            auto flags = statechart->flags_for(leaf);
+            if ((flags & kind_flag::final) and statechart->parent_for(leaf) == root) {
+                step.exited_states.push_back(leaf);
+                step.exited_states.push_back(root);
+                return true;
+            } else if (flags & kind_flag::history) {
+                auto& states_to_enter = step.entered_states;
+                if (has_memory[leaf]) {
+                    states_to_enter.assign(memory[leaf].begin(), memory[leaf].end());
+                    std::sort(states_to_enter.begin(), states_to_enter.end(), by_depth(false));
+                } else {
+                    auto initial = statechart->initial_for(leaf);
+                    if (initial != no_state) {
+                        auto closure = statechart->closure_for(initial);
+                        states_to_enter.push_back(initial);
+                        states_to_enter.insert(states_to_enter.end(), closure.begin(), closure.end());
+                    }
                 }
-            } else if (leaf.is_compound_state()) {
-                auto initial = static_cast<const CompoundState*>(&leaf)->initial;
-                if (initial != "") {
-                    return std::make_unique<MicroStep>(MicroStep{
-                        .entered_states={initial}
-                    });
+                step.exited_states.push_back(leaf);
+                return true;
+            } else if (flags & kind_flag::composite) {
+                auto closure = statechart->closure_for(leaf);
+                if (!closure.empty()) {
+                    step.entered_states.assign(closure.begin(), closure.end());
+                    return true;
                 }
             }
         }
 
-        return nullptr;
+        return false;
     }
 
-    void apply_step(MicroStep& step) {
-        auto active_configuration = configuration;
-        std::sort(active_configuration.begin(), active_configuration.end());
-        std::vector<std::shared_ptr<const Event>> sent_events;
-
-        for (auto&& state_name : step.exited_states) {
-            auto& state = statechart.state_for(state_name);
-            if (state.on_exit) {
-                for (auto&& sent_event : evaluator->execute_on_exit(state)) {
-                    sent_events.push_back(std::move(sent_event));
-                }
-            }
-
-            if (state.is_compound_state()) {
-                for (auto&& child_name : statechart.children_for(state_name)) {
-                    auto& child = statechart.state_for(child_name);
-                    if (child.is_history_state()) {
-                        std::vector<std::string> descendants;
-                        if (child.is_deep_history_state()) {
-                            descendants = statechart.descendants_for(state_name);
-                        } else {
-                            descendants = statechart.children_for(state_name);
+    // Remember the active children (shallow) or descendants (deep) of the state for each of its history states.
+    void record_history(state_id id) {
+        for (auto&& child : statechart->children_for(id)) {
+            if (statechart->is_history(child)) {
+                auto& active = memory[child];
+                active.clear();
+                if (statechart->is_deep_history(child)) {
+                    auto descendants = statechart->descendants_for(id);
+                    for (auto&& state : configuration.ones(descendants.first, descendants.last)) {
+                        active.push_back(static_cast<state_id>(state));
+                    }
+                } else {
+                    for (auto&& state : statechart->children_for(id)) {
+                        if (configuration.test(state)) {
+                            active.push_back(state);
                         }
-                        std::sort(descendants.begin(), descendants.end());
-                        std::vector<std::string> active;
-                        std::set_intersection(
-                            active_configuration.begin(), active_configuration.end(),
-                            descendants.begin(), descendants.end(),
-                            std::back_inserter(active)
-                        );
-                        memory[child_name] = std::move(active);
                     }
                 }
+                has_memory[child] = true;
             }
+        }
+    }
 
-            configuration.erase(std::find(configuration.begin(), configuration.end(), state_name));
+    // Names are recycled between macro steps, so that copying them does not allocate once their buffers are large enough.
+    void recycle_names(std::vector<std::string>& names) {
+        for (auto&& name : names) {
+            spare_names.push_back(std::move(name));
+        }
+        names.clear();
+    }
 
-            auto state_exited = MetaEvent("state exited", clock->get_time());
-            state_exited.state = state_name;
-            raise_event(std::make_shared<const MetaEvent>(std::move(state_exited)));
+    void add_name(std::vector<std::string>& names, const std::string& name) {
+        if (spare_names.empty()) {
+            names.push_back(name);
+        } else {
+            names.push_back(std::move(spare_names.back()));
+            spare_names.pop_back();
+            names.back().assign(name);
         }
+    }
 
-        if (step.transition) {
-            if (step.transition->action) {
-                for (auto&& sent_event : evaluator->execute_action(*step.transition, step.event)) {
-                    sent_events.push_back(std::move(sent_event));
-                }
+    // Next micro step of the macro step, cleared but with the storage of a previous macro step.
+    MicroStep& next_micro_step(MacroStep& macro_step, size_t& count) {
+        if (count == macro_step.steps.size()) {
+            if (spare_micro_steps.empty()) {
+                macro_step.steps.emplace_back();
+            } else {
+                macro_step.steps.push_back(std::move(spare_micro_steps.back()));
+                spare_micro_steps.pop_back();
             }
+        }
+        auto& micro_step = macro_step.steps[count++];
+        micro_step.event = nullptr;
+        micro_step.transition = nullptr;
+        recycle_names(micro_step.entered_states);
+        recycle_names(micro_step.exited_states);
+        micro_step.sent_events.clear();
+        return micro_step;
+    }
 
-            auto transition_processed = MetaEvent("transition_processed", clock->get_time());
-            transition_processed.source = step.transition->source;
-            transition_processed.target = step.transition->target;
-            transition_processed.event = step.event;
-            raise_event(std::make_shared<const MetaEvent>(std::move(transition_processed)));
+    void apply_step(const Step& step, std::vector<std::shared_ptr<const Event>>& sent_events) {
+        // History is recorded against the configuration as it was before any state is exited.
+        for (auto&& id : step.exited_states) {
+            if (statechart->is_compound(id)) {
+                record_history(id);
+            }
         }
 
-        for (auto&& state_name : step.entered_states) {
-            auto& state = statechart.state_for(state_name);
-            if (state.on_entry) {
-                for (auto&& sent_event : evaluator->execute_on_entry(state)) {
-                    sent_events.push_back(std::move(sent_event));
-                }
+        for (auto&& id : step.exited_states) {
+            auto on_exit = statechart->on_exit_for(id);
+            if (on_exit) {
+                evaluator->execute_on_entryexit_into(on_exit, sent_events);
             }
 
-            configuration.push_back(state_name);
+            configuration.reset(id);
 
-            auto state_entered = MetaEvent("state entered", clock->get_time());
-            state_entered.state = state_name;
-            raise_event(std::make_shared<const MetaEvent>(std::move(state_entered)));
+            raise_meta_event(MetaEventKind::state_exited, [id] (MetaEvent& state_exited) {
+                state_exited.state = id;
+            });
         }
 
-        for (auto& event : sent_events) {
-            raise_event(event);
+        if (step.transition) {
+            auto& transition = *step.transition->transition;
+            if (transition.action) {
+                evaluator->execute_action_into(transition, step.event, sent_events);
+            }
+
+            raise_meta_event(MetaEventKind::transition_processed, [&step] (MetaEvent& transition_processed) {
+                transition_processed.source = step.transition->source;
+                transition_processed.target = step.transition->target;
+                transition_processed.event = step.event;
+            });
         }
 
-        step.sent_events = sent_events;
-    }
+        for (auto&& id : step.entered_states) {
+            auto on_entry = statechart->on_entry_for(id);
+            if (on_entry) {
+                evaluator->execute_on_entryexit_into(on_entry, sent_events);
+            }
 
-    std::vector<MicroStep> stabilize() {
-        std::vector<MicroStep> steps;
-        auto step = create_stabilization_step(configuration);
-        while (step) {
-            apply_step(*step);
-            steps.push_back(std::move(*step));
-            step = create_stabilization_step(configuration);
+            configuration.set(id);
+
+            raise_meta_event(MetaEventKind::state_entered, [id] (MetaEvent& state_entered) {
+                state_entered.state = id;
+            });
+        }
+
+        for (auto& event : sent_events) {
+            raise_event(event);
         }
-        return steps;
     }
 
-public:
-    std::unique_ptr<MacroStep> execute_once() {
-        std::unique_ptr<MacroStep> macro_step;
-        raise_event(std::make_shared<const MetaEvent>(MetaEvent("step started", clock->get_time())));
+    // Executes a macro step, handing each of its steps to on_step(), which must apply it.
+    // Returns false if nothing was executed.
+    template <typename OnStep>
+    bool execute_steps(OnStep&& on_step) {
+        ClockStep clock_step{*clock};
+        internal_queue.advance(clock->get_time());
+        external_queue.advance(clock->get_time());
+        raise_meta_event(MetaEventKind::step_started, [] (MetaEvent&) {});
 
-        auto computed_steps = compute_steps();
+        compute_steps();
 
-        if (!computed_steps.empty()) {
-            if (computed_steps[0].event) {
+        if (step_count != 0) {
+            if (step_buffer[0].event) {
                 auto event = select_event_and_consume();
-                auto event_consumed = MetaEvent("event consumed", clock->get_time());
+                raise_meta_event(MetaEventKind::event_consumed, [&event] (MetaEvent& event_consumed) {
+                    // TODO: fix this memory leak.
+                    event_consumed.event = event;
+                });
+            }
+
+            for (size_t i = 0; i < step_count; ++i) {
+                on_step(step_buffer[i]);
+                while (create_stabilization_step(stabilization_step)) {
+                    on_step(stabilization_step);
+                }
+            }
+        }
 
-                // TODO: fix this memory leak.
-                event_consumed.event = event;
+        auto executed = step_count != 0;
+        for (size_t i = 0; i < step_count; ++i) {
+            step_buffer[i].event = nullptr;
+        }
 
-                raise_event(std::make_shared<const MetaEvent>(std::move(event_consumed)));
+        raise_meta_event(MetaEventKind::step_ended, [] (MetaEvent&) {});
+
+        return executed;
+    }
+
+    // Executes macro steps as long as keep_going() allows another one.
+    template <typename KeepGoing, typename Visitor>
+    ExecutionReport execute_bounded(KeepGoing keep_going, Visitor& visitor) {
+        ExecutionReport ret;
+        while (true) {
+            if (!keep_going()) {
+                ret.interrupted = true;
+                break;
             }
+            if (!execute_once(visitor)) {
+                break;
+            }
+            ++ret.macro_steps;
+        }
 
-            std::vector<MicroStep> executed_steps;
-            for (auto& step : computed_steps) {
-                apply_step(step);
-                executed_steps.push_back(std::move(step));
-                for (auto&& stabilizing_step : stabilize()) {
-                    executed_steps.push_back(std::move(stabilizing_step));
-                }
+        internal_queue.advance(clock->get_time());
+        external_queue.advance(clock->get_time());
+        ret.queued_events = internal_queue.size() + external_queue.size();
+        ret.has_due_events = select_event() != nullptr;
+        return ret;
+    }
 
-                macro_step = std::make_unique<MacroStep>(MacroStep{
-                    .time=clock->get_time(),
-                    .steps=std::move(executed_steps)
-                });
+public:
+    // Same as execute_once(), into a macro step the caller keeps between calls: the storage of its micro steps is
+    // reused, as well as the scratch storage of the interpreter, so that once their buffers are large enough,
+    // executing an event allocates nothing but the events sent by actions, from the event pool.
+    // Returns false, with no micro steps, if nothing was executed.
+    bool execute_once(MacroStep& macro_step) {
+        size_t count = 0;
+        execute_steps([&] (const Step& step) {
+            auto& micro_step = next_micro_step(macro_step, count);
+            micro_step.event = step.event;
+            micro_step.transition = step.transition ? step.transition->transition : nullptr;
+            apply_step(step, micro_step.sent_events);
+            for (auto&& id : step.exited_states) {
+                add_name(micro_step.exited_states, statechart->name_for(id));
             }
-        } else {
-            macro_step = nullptr;
+            for (auto&& id : step.entered_states) {
+                add_name(micro_step.entered_states, statechart->name_for(id));
+            }
+            macro_step.time = clock->get_time();
+        });
+
+        while (macro_step.steps.size() > count) {
+            auto& unused = macro_step.steps.back();
+            unused.event = nullptr;
+            unused.sent_events.clear();
+            spare_micro_steps.push_back(std::move(unused));
+            macro_step.steps.pop_back();
         }
 
-        raise_event(std::make_shared<const MetaEvent>(MetaEvent("step ended", clock->get_time())));
+        return count != 0;
+    }
 
-        return macro_step;
+    // Executes a macro step without materializing it: the visitor is called with a view of each micro step,
+    // once it is applied. Pass discard_steps to only apply them.
+    // Returns false if nothing was executed.
+    template <typename Visitor>
+    bool execute_once(Visitor&& visitor) {
+        return execute_steps([&] (const Step& step) {
+            viewed_sent_events.clear();
+            apply_step(step, viewed_sent_events);
+            visitor(MicroStepView{
+                .time=clock->get_time(),
+                .event=step.event.get(),
+                .transition=step.transition ? step.transition->transition : nullptr,
+                .entered_states={step.entered_states.data(), step.entered_states.data() + step.entered_states.size()},
+                .exited_states={step.exited_states.data(), step.exited_states.data() + step.exited_states.size()},
+                .sent_events={viewed_sent_events.data(), viewed_sent_events.data() + viewed_sent_events.size()}
+            });
+            viewed_sent_events.clear();
+        });
+    }
+
+    std::unique_ptr<MacroStep> execute_once() {
+        MacroStep macro_step{};
+        if (!execute_once(macro_step)) {
+            return nullptr;
+        }
+        return std::make_unique<MacroStep>(std::move(macro_step));
     }
 
     std::vector<MacroStep> execute() {
@@ -532,6 +825,93 @@ public:
 
         return ret;
     }
+
+    // Same as execute(), streaming the micro steps to the visitor instead of returning them.
+    // Returns the number of macro steps executed.
+    template <typename Visitor>
+    size_t execute(Visitor&& visitor) {
+        size_t count = 0;
+        while (execute_once(visitor)) {
+            ++count;
+        }
+        return count;
+    }
+
+    // Same as execute(visitor), for at most the given number of macro steps.
+    template <typename Visitor = const DiscardSteps&>
+    ExecutionReport execute_for(size_t max_macro_steps, Visitor&& visitor = discard_steps) {
+        size_t count = 0;
+        return execute_bounded([&] { return count++ < max_macro_steps; }, visitor);
+    }
+
+    // Same as execute(visitor), starting no macro step once the deadline is reached, so that the last one
+    // may end after it. The deadline is in real time, whatever the clock of the interpreter.
+    template <typename Visitor = const DiscardSteps&>
+    ExecutionReport execute_until(std::chrono::steady_clock::time_point deadline, Visitor&& visitor = discard_steps) {
+        return execute_bounded([&] { return std::chrono::steady_clock::now() < deadline; }, visitor);
+    }
+
+    // Queues the event from any thread, and wakes up run(). Its delay counts from when run() takes it.
+    void post(std::shared_ptr<const Event> event) {
+        {
+            std::lock_guard<std::mutex> lock(posted_mutex);
+            posted_events.push_back(std::move(event));
+        }
+        posted_ready.notify_one();
+    }
+
+    void post(std::string name) {
+        post(make_pooled<Event>(event_pool.get(), std::move(name)));
+    }
+
+    // Makes run() return between two macro steps, from any thread. If run() is not running, the next one returns
+    // before any macro step, leaving the posted events queued.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(posted_mutex);
+            stop_requested = true;
+        }
+        posted_ready.notify_one();
+    }
+
+    // Executes the events as they are due until stop() is called, sleeping in between until the earliest queued
+    // event is due or an event is posted. Meanwhile, only post() and stop() may be called from other threads.
+    // The clock must follow real time, as SteadyClock does.
+    template <typename Visitor = const DiscardSteps&>
+    void run(Visitor&& visitor = discard_steps) {
+        std::vector<std::shared_ptr<const Event>> taken;
+        auto woken = [this] {
+            return stop_requested or !posted_events.empty();
+        };
+
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(posted_mutex);
+                taken.swap(posted_events);
+            }
+            if (!taken.empty()) {
+                queue_batch(taken);
+                taken.clear();
+            }
+
+            execute_bounded([this] { return !stop_requested; }, visitor);
+
+            auto next_time = std::min(internal_queue.next_time(), external_queue.next_time());
+            std::unique_lock<std::mutex> lock(posted_mutex);
+            if (stop_requested) {
+                stop_requested = false;
+                return;
+            }
+            if (next_time == std::numeric_limits<double>::infinity()) {
+                posted_ready.wait(lock, woken);
+            } else {
+                // Rounded up, so as not to wake up before the event is due, and capped against overflows.
+                auto delay = std::min(std::max(next_time - clock->get_time(), 0.0), 3600.0);
+                auto timeout = std::chrono::nanoseconds(static_cast<std::int64_t>(std::ceil(delay * 1e9)));
+                posted_ready.wait_until(lock, std::chrono::steady_clock::now() + timeout, woken);
+            }
+        }
+    }
 };
 
 }  // namespace sismicpp
@@ -0,0 +1,276 @@
+#ifndef INCLUDE_SISMICPP_INTERPRETER_QUEUE
+#define INCLUDE_SISMICPP_INTERPRETER_QUEUE
+
+#include "model/events.h"
+#include "model/symbols.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace sismicpp {
+
+// Queued event with the symbol of its name, resolved once when the event is queued.
+struct QueuedEvent {
+    double time;
+    symbol_id symbol;
+    std::shared_ptr<const Event> event;
+    EventHandle handle = {};
+    // Insertion order, set by EventQueue::push().
+    std::uint64_t order = 0;
+};
+
+// Handle carried by the event, if it was sent by an action or an entry/exit function.
+inline EventHandle handle_for(const Event& event) {
+    return event.is_internal_event() ? static_cast<const InternalEvent&>(event).handle : EventHandle{};
+}
+
+// Events ordered by time, then by insertion order.
+// Events due by the last advance() are ready: those that do not come before the last one of the FIFO,
+// such as undelayed events under a clock that does not go backwards, are appended to a ring buffer in
+// constant time, the others go to a binary heap. Later events wait in a hierarchical timing wheel of
+// 4 levels of 64 slots, and in an overflow heap beyond its horizon. The resolution of the wheel only
+// affects performance: ready events keep their exact order.
+// Cancelled events are discarded by advance(), without ever becoming the front.
+struct EventQueue {
+private:
+    static constexpr unsigned slot_bits = 6;
+    static constexpr unsigned slot_count = 1u << slot_bits;
+    static constexpr unsigned level_count = 4;
+
+    // Ring buffer with a power of two capacity.
+    std::vector<QueuedEvent> fifo = {};
+    size_t fifo_first = 0;
+    size_t fifo_size = 0;
+
+    std::vector<QueuedEvent> heap = {};
+    std::uint64_t next_order = 0;
+
+    // Slots of level l hold the events whose tick first differs from the current tick in bits
+    // [l * slot_bits, (l + 1) * slot_bits), so that a slot is only split when the current tick reaches it.
+    double resolution;
+    std::uint64_t current_tick = 0;
+    std::vector<std::vector<QueuedEvent>> slots;
+    std::uint64_t occupied[level_count] = {};
+    std::vector<QueuedEvent> overflow = {};
+    size_t delayed_count = 0;
+
+    static bool comes_after(const QueuedEvent& first, const QueuedEvent& second) {
+        if (first.time != second.time) {
+            return first.time > second.time;
+        }
+        return first.order > second.order;
+    }
+
+    std::uint64_t tick_for(double time) const {
+        auto ticks = time / resolution;
+        if (!(ticks > 0)) {
+            return 0;
+        }
+        if (ticks >= static_cast<double>(std::numeric_limits<std::uint64_t>::max())) {
+            return std::numeric_limits<std::uint64_t>::max();
+        }
+        return static_cast<std::uint64_t>(ticks);
+    }
+
+    QueuedEvent& fifo_at(size_t index) {
+        return fifo[(fifo_first + index) & (fifo.size() - 1)];
+    }
+
+    const QueuedEvent& fifo_at(size_t index) const {
+        return fifo[(fifo_first + index) & (fifo.size() - 1)];
+    }
+
+    void grow_fifo(size_t capacity) {
+        std::vector<QueuedEvent> grown(capacity);
+        for (size_t i = 0; i < fifo_size; ++i) {
+            grown[i] = std::move(fifo_at(i));
+        }
+        fifo = std::move(grown);
+        fifo_first = 0;
+    }
+
+    bool front_in_fifo() const {
+        return fifo_size != 0 and (heap.empty() or !comes_after(fifo_at(0), heap.front()));
+    }
+
+    void push_ready(QueuedEvent entry) {
+        if (fifo_size == 0 or !comes_after(fifo_at(fifo_size - 1), entry)) {
+            if (fifo_size == fifo.size()) {
+                grow_fifo(fifo.empty() ? 16 : fifo.size() * 2);
+            }
+            fifo_at(fifo_size++) = std::move(entry);
+        } else {
+            heap.push_back(std::move(entry));
+            std::push_heap(heap.begin(), heap.end(), comes_after);
+        }
+    }
+
+    void push_delayed(QueuedEvent entry) {
+        auto tick = tick_for(entry.time);
+        if (tick <= current_tick) {
+            push_ready(std::move(entry));
+            return;
+        }
+
+        ++delayed_count;
+        auto level = (63 - static_cast<unsigned>(__builtin_clzll(tick ^ current_tick))) / slot_bits;
+        if (level >= level_count) {
+            overflow.push_back(std::move(entry));
+            std::push_heap(overflow.begin(), overflow.end(), comes_after);
+        } else {
+            auto slot = (tick >> (level * slot_bits)) & (slot_count - 1);
+            slots[level * slot_count + slot].push_back(std::move(entry));
+            occupied[level] |= std::uint64_t{1} << slot;
+        }
+    }
+
+    // Moves the events of a slot, or of the overflow heap, down the wheel once the current tick reached it.
+    void cascade(std::vector<QueuedEvent>& entries) {
+        std::vector<QueuedEvent> moved;
+        moved.swap(entries);
+        delayed_count -= moved.size();
+        for (auto&& entry : moved) {
+            if (!entry.handle.is_cancelled()) {
+                push_delayed(std::move(entry));
+            }
+        }
+
+        // Events only cascade to lower levels, so the slot is still empty and can keep its storage.
+        moved.clear();
+        entries.swap(moved);
+    }
+
+public:
+    // Ticks of a millisecond by default.
+    EventQueue() : EventQueue(0.001) {}
+
+    explicit EventQueue(double resolution) :
+    resolution(resolution),
+    slots(level_count * slot_count) {}
+
+    // Only ready events can be at the front.
+    bool empty() const {
+        return fifo_size == 0 and heap.empty();
+    }
+
+    // Ready and delayed events, including the cancelled ones that were not discarded yet.
+    size_t size() const {
+        return fifo_size + heap.size() + delayed_count;
+    }
+
+    // Makes room for count more undelayed events in the FIFO, with at most one reallocation.
+    void reserve(size_t count) {
+        auto capacity = fifo.empty() ? size_t{16} : fifo.size();
+        while (capacity < fifo_size + count) {
+            capacity *= 2;
+        }
+        if (capacity != fifo.size()) {
+            grow_fifo(capacity);
+        }
+    }
+
+    // Returns the insertion order of the event.
+    std::uint64_t push(QueuedEvent queued) {
+        auto order = next_order++;
+        queued.order = order;
+        push_delayed(std::move(queued));
+        return order;
+    }
+
+    // Makes ready the events due at the given time, and discards the cancelled events at the front.
+    void advance(double time) {
+        auto target_tick = tick_for(time);
+        while (true) {
+            unsigned level = 0;
+            while (level < level_count and occupied[level] == 0) {
+                ++level;
+            }
+
+            if (level < level_count) {
+                // The first occupied slot of the lowest occupied level holds the earliest events.
+                auto slot = static_cast<unsigned>(__builtin_ctzll(occupied[level]));
+                auto shift = level * slot_bits;
+                auto start = (current_tick >> (shift + slot_bits) << (shift + slot_bits)) | (std::uint64_t{slot} << shift);
+                if (start > target_tick) {
+                    break;
+                }
+                current_tick = start;
+                occupied[level] &= ~(std::uint64_t{1} << slot);
+                cascade(slots[level * slot_count + slot]);
+            } else if (!overflow.empty()) {
+                auto shift = level_count * slot_bits;
+                auto start = tick_for(overflow.front().time) >> shift << shift;
+                if (start > target_tick) {
+                    break;
+                }
+                current_tick = start;
+                std::vector<QueuedEvent> reached;
+                while (!overflow.empty() and (tick_for(overflow.front().time) >> shift << shift) == start) {
+                    std::pop_heap(overflow.begin(), overflow.end(), comes_after);
+                    reached.push_back(std::move(overflow.back()));
+                    overflow.pop_back();
+                }
+                cascade(reached);
+            } else {
+                break;
+            }
+        }
+        current_tick = std::max(current_tick, target_tick);
+
+        while (!empty() and front().handle.is_cancelled()) {
+            pop();
+        }
+    }
+
+    // Time of the earliest event, ready or delayed, or infinity without events. Cancelled events that were not
+    // discarded yet are included, so it may come too early but never too late.
+    double next_time() const {
+        if (!empty()) {
+            return front().time;
+        }
+        for (unsigned level = 0; level < level_count; ++level) {
+            if (occupied[level] != 0) {
+                // Events of the first occupied slot of the lowest occupied level come first, but not in order.
+                auto slot = static_cast<unsigned>(__builtin_ctzll(occupied[level]));
+                auto ret = std::numeric_limits<double>::infinity();
+                for (auto&& entry : slots[level * slot_count + slot]) {
+                    ret = std::min(ret, entry.time);
+                }
+                return ret;
+            }
+        }
+        if (!overflow.empty()) {
+            return overflow.front().time;
+        }
+        return std::numeric_limits<double>::infinity();
+    }
+
+    // Undefined if the queue is empty.
+    const QueuedEvent& front() const {
+        return front_in_fifo() ? fifo_at(0) : heap.front();
+    }
+
+    QueuedEvent pop() {
+        if (front_in_fifo()) {
+            auto& entry = fifo_at(0);
+            auto ret = std::move(entry);
+            entry = {0, no_symbol, nullptr};
+            fifo_first = (fifo_first + 1) & (fifo.size() - 1);
+            --fifo_size;
+            return ret;
+        }
+
+        std::pop_heap(heap.begin(), heap.end(), comes_after);
+        auto ret = std::move(heap.back());
+        heap.pop_back();
+        return ret;
+    }
+};
+
+}  // namespace sismicpp
+
+#endif  // INCLUDE
@@ -1,12 +1,21 @@
 #ifndef INCLUDE_SISMICPP_MODEL_BUILDER
 #define INCLUDE_SISMICPP_MODEL_BUILDER
 
+#include "model/bulk.h"
 #include "model/elements.h"
 #include "model/statechart.h"
+#include "exceptions.h"
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #define ATTRIBUTE_SETTER(attribute, arg_type) auto attribute = [] (auto attribute) { \
-    return [attribute] (arg_type& arg) -> decltype(arg)& {                     \
-        arg.attribute = attribute;                                         \
+    return [attribute=std::move(attribute)] (arg_type& arg) mutable -> decltype(arg)& { \
+        arg.attribute = std::move(attribute);                              \
         return arg;                                                        \
     };                                                                     \
 };
@@ -17,83 +26,220 @@ namespace sismicpp {
 namespace builder {
 namespace detail {
 
-template <typename... Args>
-void swallow(Args&&...) {}
-
-struct PartialState {
+// A state written by the DSL, before it becomes a State of the StateChart.
+struct StateDraft {
     std::string name = "";
-    std::string parent = "";
     std::string initial = "";
     std::string type = "";
     std::string memory = "";
+    size_t parent = sismicpp::detail::no_index;
     bool is_orthogonal = false;
     bool is_compound = false;
+    bool has_transitions = false;
     on_entryexit_func on_entry = nullptr;
-    on_entryexit_func on_exit= nullptr;
+    on_entryexit_func on_exit = nullptr;
+};
+
+// Chart under construction: states in pre-order and transitions, each written once by the DSL.
+struct ChartDraft {
+    std::vector<StateDraft> states = {};
     std::vector<Transition> transitions = {};
-    std::vector<PartialState> inner_states = {};
-
-    void add_all_states(StateChart& statechart) {
-        auto state = [&] () -> std::unique_ptr<State> {
-            if (type != "") {
-                if (is_orthogonal) {
-                    throw statechart_error("Parallel state '" + name + "' cannot also be of type '" + type);
-                } else if (is_compound or !inner_states.empty()) {
-                    throw statechart_error("Compound state '" + name + "' cannot also be of type '" + type);
-                } else if (!transitions.empty()) {
-                    throw statechart_error("State '" + name + "' cannot be of type '" + type + " and also have transitions");
-                } else if (type == "final") {
-                    return std::make_unique<FinalState>(name);
-                } else if (type == "shallow history") {
-                    return std::make_unique<ShallowHistoryState>(name, memory);
-                } else if (type == "deep history") {
-                    return std::make_unique<DeepHistoryState>(name, memory);
-                }
-            } else if (is_orthogonal) {
-                return std::make_unique<OrthogonalState>(name);
-            } else if (is_compound) {
-                return std::make_unique<CompoundState>(name, std::move(initial));
-            }
+    std::vector<size_t> sources = {};
 
-            return std::make_unique<BasicState>(name);
-        }();
+    size_t add_state(size_t parent, bool is_orthogonal) {
+        states.emplace_back();
+        states.back().parent = parent;
+        states.back().is_orthogonal = is_orthogonal;
+        if (parent != sismicpp::detail::no_index) {
+            states[parent].is_compound = true;
+        }
+        return states.size() - 1;
+    }
 
-        state->on_entry = on_entry;
-        state->on_exit = on_exit;
+    Transition& add_transition(size_t source) {
+        transitions.push_back(Transition{""});
+        sources.push_back(source);
+        return transitions.back();
+    }
 
-        statechart.add_state(std::move(state), parent);
+    StateChart build(StateChart header) {
+        for (size_t i = 0; i < transitions.size(); ++i) {
+            transitions[i].source = states[sources[i]].name;
+        }
 
-        for (auto&& inner_state : inner_states) {
-            inner_state.parent = name;
-            inner_state.add_all_states(statechart);
+        // Children come after their parent, so names can be moved from the last state to the first.
+        std::vector<BulkStateSpec> specs(states.size());
+        for (size_t i = states.size(); i-- > 0;) {
+            auto& state = states[i];
+            specs[i].parent = state.parent == sismicpp::detail::no_index ? "" : states[state.parent].name;
+            specs[i].state = make_state(state);
         }
+
+        BulkBuilder builder{std::move(header.name)};
+        builder.set_description(std::move(header.description)).set_preamble(header.preamble);
+        builder.add_states(std::move(specs)).add_transitions(std::move(transitions));
+        return builder.build();
     }
 
-    void add_all_transitions(StateChart& statechart) {
-        for (auto&& transition : transitions) {
-            transition.source = name;
-            statechart.add_transition(std::move(transition));
-        }
-        
-        for (auto&& inner_state : inner_states) {
-            inner_state.add_all_transitions(statechart);
+private:
+    static std::unique_ptr<State> make_state(StateDraft& draft) {
+        std::unique_ptr<State> state;
+        if (draft.type != "") {
+            if (draft.is_orthogonal) {
+                throw statechart_error("Parallel state '" + draft.name + "' cannot also be of type '" + draft.type);
+            } else if (draft.is_compound) {
+                throw statechart_error("Compound state '" + draft.name + "' cannot also be of type '" + draft.type);
+            } else if (draft.has_transitions) {
+                throw statechart_error("State '" + draft.name + "' cannot be of type '" + draft.type + " and also have transitions");
+            } else if (draft.type == "final") {
+                state = std::make_unique<FinalState>(std::move(draft.name));
+            } else if (draft.type == "shallow history") {
+                state = std::make_unique<ShallowHistoryState>(std::move(draft.name), std::move(draft.memory));
+            } else {
+                state = std::make_unique<DeepHistoryState>(std::move(draft.name), std::move(draft.memory));
+            }
+        } else if (draft.is_orthogonal) {
+            state = std::make_unique<OrthogonalState>(std::move(draft.name));
+        } else if (draft.is_compound) {
+            state = std::make_unique<CompoundState>(std::move(draft.name), std::move(draft.initial));
+        } else {
+            state = std::make_unique<BasicState>(std::move(draft.name));
         }
+
+        state->on_entry = draft.on_entry;
+        state->on_exit = draft.on_exit;
+        return state;
     }
+};
 
-    PartialState& operator()(PartialState& parent_state) && {
-        parent_state.is_compound = true;
-        parent_state.inner_states.push_back(std::move(*this));
-        return parent_state;
+constexpr size_t sum() {
+    return 0;
+}
+
+template <typename... Rest>
+constexpr size_t sum(size_t first, Rest... rest) {
+    return first + sum(rest...);
+}
+
+template <typename Arg>
+struct counts {
+    static constexpr size_t states = 0;
+    static constexpr size_t transitions = 0;
+};
+
+template <typename... Args>
+struct PartialTransition {
+    std::tuple<Args...> args;
+
+    void add(ChartDraft& chart, size_t source) && {
+        add(chart, chart.transitions.size(), source, std::index_sequence_for<Args...>{});
+    }
+
+private:
+    template <size_t... I>
+    void add(ChartDraft& chart, size_t id, size_t source, std::index_sequence<I...>) {
+        chart.add_transition(source);
+        // Braced lists are evaluated left to right, so arguments apply in the order they are written.
+        int ordered[] = {0, (std::get<I>(std::move(args))(chart.transitions[id]), 0)...};
+        (void) ordered;
     }
 };
 
-struct PartialRootState : PartialState {
-    StateChart& operator()(StateChart& statechart) {
-        add_all_states(statechart);
-        add_all_transitions(statechart);
-        return statechart;
+template <typename... Args>
+struct counts<PartialTransition<Args...>> {
+    static constexpr size_t states = 0;
+    static constexpr size_t transitions = 1;
+};
+
+// Arguments are kept until the whole tree is written, so that nothing is copied between nesting levels.
+template <typename... Args>
+struct PartialState {
+    static constexpr size_t states = 1 + sum(counts<Args>::states...);
+    static constexpr size_t transitions = sum(counts<Args>::transitions...);
+
+    bool is_orthogonal;
+    std::tuple<Args...> args;
+
+    // States are added depth-first in pre-order.
+    void add_states(ChartDraft& chart, size_t parent) {
+        add_states(chart, chart.add_state(parent, is_orthogonal), std::index_sequence_for<Args...>{});
+    }
+
+    // Transitions of a state come before the ones of its descendants.
+    void add_transitions(ChartDraft& chart, size_t& next_id) {
+        auto id = next_id++;
+        add_transitions(chart, id, next_id, std::index_sequence_for<Args...>{});
+    }
+
+private:
+    template <size_t... I>
+    void add_states(ChartDraft& chart, size_t id, std::index_sequence<I...>) {
+        int ordered[] = {0, (add_state_arg(chart, id, std::get<I>(std::move(args))), 0)...};
+        (void) ordered;
+    }
+
+    template <size_t... I>
+    void add_transitions(ChartDraft& chart, size_t id, size_t& next_id, std::index_sequence<I...>) {
+        int own[] = {0, (add_own_transition(chart, id, std::get<I>(std::move(args))), 0)...};
+        int inner[] = {0, (add_inner_transitions(chart, next_id, std::get<I>(std::move(args))), 0)...};
+        (void) own;
+        (void) inner;
+    }
+
+    template <typename Attribute>
+    static void add_state_arg(ChartDraft& chart, size_t id, Attribute&& attribute) {
+        attribute(chart.states[id]);
+    }
+
+    template <typename... Inner>
+    static void add_state_arg(ChartDraft& chart, size_t id, PartialTransition<Inner...>&&) {
+        chart.states[id].has_transitions = true;
+    }
+
+    template <typename... Inner>
+    static void add_state_arg(ChartDraft& chart, size_t id, PartialState<Inner...>&& inner_state) {
+        inner_state.add_states(chart, id);
+    }
+
+    template <typename Arg>
+    static void add_own_transition(ChartDraft&, size_t, Arg&&) {}
+
+    template <typename... Inner>
+    static void add_own_transition(ChartDraft& chart, size_t id, PartialTransition<Inner...>&& partial_transition) {
+        std::move(partial_transition).add(chart, id);
+    }
+
+    template <typename Arg>
+    static void add_inner_transitions(ChartDraft&, size_t&, Arg&&) {}
+
+    template <typename... Inner>
+    static void add_inner_transitions(ChartDraft& chart, size_t& next_id, PartialState<Inner...>&& inner_state) {
+        inner_state.add_transitions(chart, next_id);
     }
 };
+
+template <typename... Inner>
+struct counts<PartialState<Inner...>> {
+    static constexpr size_t states = PartialState<Inner...>::states;
+    static constexpr size_t transitions = PartialState<Inner...>::transitions;
+};
+
+template <typename Attribute>
+void apply_statechart_arg(StateChart& header, ChartDraft&, Attribute&& attribute) {
+    attribute(header);
+}
+
+template <typename... Inner>
+void apply_statechart_arg(StateChart&, ChartDraft& chart, PartialState<Inner...>&& root) {
+    chart.states.reserve(chart.states.size() + PartialState<Inner...>::states);
+    chart.transitions.reserve(chart.transitions.size() + PartialState<Inner...>::transitions);
+    chart.sources.reserve(chart.sources.size() + PartialState<Inner...>::transitions);
+
+    auto first_id = chart.states.size();
+    root.add_states(chart, sismicpp::detail::no_index);
+    root.add_transitions(chart, first_id);
+}
+
 }  // namespace detail
 
 ATTRIBUTE_SETTER_AUTO(name);
@@ -104,7 +250,7 @@ ATTRIBUTE_SETTER_AUTO(on_exit);
 ATTRIBUTE_SETTER(description, StateChart);
 ATTRIBUTE_SETTER(preamble, StateChart);
 
-ATTRIBUTE_SETTER(memory, detail::PartialState);
+ATTRIBUTE_SETTER(memory, detail::StateDraft);
 
 ATTRIBUTE_SETTER(event, Transition);
 ATTRIBUTE_SETTER(guard, Transition);
@@ -117,45 +263,39 @@ auto type = [] (std::string type) {
         type != "deep history") {
         throw sismic_error("State type '" + type + "' is not one of 'final', 'shallow history', or 'deep history'");
     }
-    return [type=std::move(type)] (detail::PartialState& partial_state) -> detail::PartialState& {
-        partial_state.type = type;
-        return partial_state;
+    return [type=std::move(type)] (detail::StateDraft& state) mutable -> detail::StateDraft& {
+        state.type = std::move(type);
+        return state;
     };
 };
 
 auto transition = [] (auto&&... args) {
-    Transition transition{""};
-    detail::swallow(std::forward<decltype(args)>(args)(transition)...);
-    return [transition] (detail::PartialState& arg) -> decltype(arg)& {
-        arg.transitions.push_back(transition);
-        return arg;
+    return detail::PartialTransition<std::decay_t<decltype(args)>...>{
+        std::make_tuple(std::forward<decltype(args)>(args)...)
     };
 };
 
 auto state = [] (auto&&... args) {
-    detail::PartialState partial_state;
-    detail::swallow(std::forward<decltype(args)>(args)(partial_state)...);
-    return partial_state;
+    return detail::PartialState<std::decay_t<decltype(args)>...>{
+        false, std::make_tuple(std::forward<decltype(args)>(args)...)
+    };
 };
 
 auto parallel_state = [] (auto&&... args) {
-    detail::PartialState partial_state;
-    partial_state.is_orthogonal = true;
-    detail::swallow(std::forward<decltype(args)>(args)(partial_state)...);
-    return partial_state;
+    return detail::PartialState<std::decay_t<decltype(args)>...>{
+        true, std::make_tuple(std::forward<decltype(args)>(args)...)
+    };
 };
 
-auto root_state = [] (auto&&... args) {
-    detail::PartialRootState partial_root_state;
-    detail::swallow(std::forward<decltype(args)>(args)(partial_root_state)...);
-    return partial_root_state;
-};
+auto root_state = state;
 
+// Validation happens while the states are added, in BulkBuilder::build().
 auto build_statechart = [] (auto&&... args) -> StateChart {
-    StateChart ret{""};
-    detail::swallow(std::forward<decltype(args)>(args)(ret)...);
-    ret.validate();
-    return ret;
+    StateChart header{""};
+    detail::ChartDraft chart;
+    int ordered[] = {0, (detail::apply_statechart_arg(header, chart, std::forward<decltype(args)>(args)), 0)...};
+    (void) ordered;
+    return chart.build(std::move(header));
 };
 
 }
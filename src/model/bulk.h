@@ -0,0 +1,270 @@
+#ifndef INCLUDE_SISMICPP_MODEL_BULK
+#define INCLUDE_SISMICPP_MODEL_BULK
+
+#include "model/elements.h"
+#include "model/statechart.h"
+#include "exceptions.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sismicpp {
+
+namespace detail {
+
+constexpr size_t no_index = std::numeric_limits<size_t>::max();
+
+}  // namespace detail
+
+struct BulkStateSpec {
+    std::unique_ptr<State> state;
+    std::string parent;
+};
+
+// Durations of the last BulkBuilder::build(), in seconds.
+struct BuildReport {
+    size_t states = 0;
+    size_t transitions = 0;
+    double build_time = 0;
+    double validation_time = 0;
+};
+
+// Builds a StateChart from batches of states and transitions, for charts too large for add_state() and
+// add_transition() one at a time. Names are resolved once through a hash index, the maps of the StateChart
+// are filled in name order, and validation is a single pass with the same errors as StateChart::validate().
+// States may be given in any order, as long as every parent is given at some point.
+struct BulkBuilder {
+private:
+    StateChart statechart;
+    std::vector<BulkStateSpec> state_specs = {};
+    std::vector<Transition> transition_specs = {};
+    BuildReport report = {};
+
+public:
+    explicit BulkBuilder(std::string name) : statechart(std::move(name)) {}
+
+    BulkBuilder& set_description(std::string description) {
+        statechart.description = std::move(description);
+        return *this;
+    }
+
+    BulkBuilder& set_preamble(preamble_func preamble) {
+        statechart.preamble = preamble;
+        return *this;
+    }
+
+    BulkBuilder& add_states(std::vector<BulkStateSpec> batch) {
+        if (state_specs.empty()) {
+            state_specs = std::move(batch);
+        } else {
+            state_specs.reserve(state_specs.size() + batch.size());
+            std::move(batch.begin(), batch.end(), std::back_inserter(state_specs));
+        }
+        return *this;
+    }
+
+    template <typename TState>
+    typename std::enable_if<std::is_base_of<State, TState>::value, BulkBuilder&>::type
+    add_state(TState state, std::string parent) {
+        state_specs.push_back({std::make_unique<TState>(std::move(state)), std::move(parent)});
+        return *this;
+    }
+
+    BulkBuilder& add_transitions(std::vector<Transition> batch) {
+        if (transition_specs.empty()) {
+            transition_specs = std::move(batch);
+        } else {
+            transition_specs.reserve(transition_specs.size() + batch.size());
+            std::move(batch.begin(), batch.end(), std::back_inserter(transition_specs));
+        }
+        return *this;
+    }
+
+    BulkBuilder& add_transition(Transition transition) {
+        transition_specs.push_back(std::move(transition));
+        return *this;
+    }
+
+    const BuildReport& get_report() const {
+        return report;
+    }
+
+    // Consumes the batches; the builder is left empty.
+    StateChart build() {
+        using clock = std::chrono::steady_clock;
+        auto seconds = [] (clock::duration duration) {
+            return std::chrono::duration<double>(duration).count();
+        };
+
+        auto start = clock::now();
+        std::unordered_map<std::string, size_t> index;
+        std::vector<size_t> parents;
+        build_indices(index, parents);
+        auto built = clock::now();
+        validate(index, parents);
+        auto validated = clock::now();
+        fill(parents);
+        auto filled = clock::now();
+
+        report = {
+            .states=statechart.states.size(),
+            .transitions=statechart.transitions.size(),
+            .build_time=seconds(built - start) + seconds(filled - validated),
+            .validation_time=seconds(validated - built)
+        };
+
+        state_specs.clear();
+        transition_specs.clear();
+
+        StateChart ret{std::move(statechart)};
+        statechart = StateChart{ret.name};
+        return ret;
+    }
+
+private:
+    // Same checks as StateChart::add_state() and add_transition(), against the hash index.
+    void build_indices(std::unordered_map<std::string, size_t>& index, std::vector<size_t>& parents) const {
+        index.reserve(state_specs.size());
+        for (size_t i = 0; i < state_specs.size(); ++i) {
+            auto& name = state_specs[i].state->name;
+            if (name == "") {
+                throw statechart_error("State must have a name");
+            }
+            if (!index.emplace(name, i).second) {
+                throw statechart_error("State " + name + " already exists!");
+            }
+        }
+
+        parents.assign(state_specs.size(), detail::no_index);
+        auto has_root = false;
+        for (size_t i = 0; i < state_specs.size(); ++i) {
+            auto& spec = state_specs[i];
+            if (spec.parent == "") {
+                if (has_root) {
+                    throw statechart_error("Root already defined. Try adding the state with an existing parent.");
+                }
+                has_root = true;
+                continue;
+            }
+
+            auto it = index.find(spec.parent);
+            if (it == index.end()) {
+                throw statechart_error("Parent '" + spec.parent + "' of '" + spec.state->name + "' does not exist!");
+            }
+
+            auto& parent_state = *state_specs[it->second].state;
+            if (!parent_state.is_composite_state() or (spec.state->is_history_state() and !parent_state.is_compound_state())) {
+                throw statechart_error("State '" + parent_state.name + "' cannot be used as a parent for '" + spec.state->name + "'");
+            }
+            parents[i] = it->second;
+        }
+
+        // Unlike with add_state(), a parent may be given after its children, so cycles must be ruled out.
+        std::vector<char> reaches_root(state_specs.size(), false);
+        std::vector<char> on_path(state_specs.size(), false);
+        std::vector<size_t> path;
+        for (size_t i = 0; i < state_specs.size(); ++i) {
+            auto current = i;
+            while (current != detail::no_index and !reaches_root[current]) {
+                if (on_path[current]) {
+                    throw statechart_error("State '" + state_specs[current].state->name + "' cannot be its own ancestor");
+                }
+                on_path[current] = true;
+                path.push_back(current);
+                current = parents[current];
+            }
+            for (auto&& state : path) {
+                reaches_root[state] = true;
+            }
+            path.clear();
+        }
+
+        for (auto&& transition : transition_specs) {
+            auto it = index.find(transition.source);
+            if (it == index.end()) {
+                throw statechart_error("Unknown source state " + transition.source);
+            }
+            if (!state_specs[it->second].state->is_transitions_state()) {
+                throw statechart_error("Cannot add transition on state " + transition.source);
+            }
+            if (transition.target != "" and index.find(transition.target) == index.end()) {
+                throw statechart_error("Unknown target state " + transition.target);
+            }
+        }
+    }
+
+    // Same checks as StateChart::validate(), in one pass over the states.
+    void validate(const std::unordered_map<std::string, size_t>& index, const std::vector<size_t>& parents) const {
+        for (size_t i = 0; i < state_specs.size(); ++i) {
+            auto& state = *state_specs[i].state;
+            if (state.is_compound_state()) {
+                auto& initial = static_cast<const CompoundState&>(state).initial;
+                auto it = index.find(initial);
+                if (it == index.end()) {
+                    throw statechart_error("Initial state '" + initial + "' of state '" + state.name + "' does not exist");
+                }
+                if (parents[it->second] != i) {
+                    throw statechart_error("Initial state '" + initial + "' of state '" + state.name + "' must be a child state");
+                }
+            } else if (state.is_history_state()) {
+                auto& memory = static_cast<const HistoryState&>(state).memory;
+                if (memory == "") {
+                    continue;
+                }
+                if (memory == state.name) {
+                    throw statechart_error("Initial memory of '" + memory + "' of state '" + state.name + "' cannot target itself");
+                }
+                auto it = index.find(memory);
+                if (it == index.end()) {
+                    throw statechart_error("Initial memory of '" + memory + "' of state '" + state.name + "' does not exist");
+                }
+                if (parents[it->second] != parents[i]) {
+                    throw statechart_error("Initial memory of '" + memory + "' of state '" + state.name + "' must be a parent's child");
+                }
+            }
+        }
+    }
+
+    // Maps are filled in name order with end() hints, so each insertion takes constant time.
+    void fill(const std::vector<size_t>& parents) {
+        std::vector<size_t> by_name(state_specs.size());
+        for (size_t i = 0; i < by_name.size(); ++i) {
+            by_name[i] = i;
+        }
+        std::sort(by_name.begin(), by_name.end(), [this] (size_t first, size_t second) {
+            return state_specs[first].state->name < state_specs[second].state->name;
+        });
+
+        std::vector<std::vector<std::string>> children(state_specs.size());
+        std::vector<std::string> roots;
+        for (size_t i = 0; i < state_specs.size(); ++i) {
+            auto& name = state_specs[i].state->name;
+            (parents[i] == detail::no_index ? roots : children[parents[i]]).push_back(name);
+        }
+
+        statechart.children.clear();
+        statechart.children.emplace_hint(statechart.children.end(), "", std::move(roots));
+        for (auto&& i : by_name) {
+            auto& spec = state_specs[i];
+            auto name = spec.state->name;
+            statechart.parent.emplace_hint(statechart.parent.end(), name, std::move(spec.parent));
+            statechart.children.emplace_hint(statechart.children.end(), name, std::move(children[i]));
+            statechart.states.emplace_hint(statechart.states.end(), std::move(name), std::move(spec.state));
+        }
+
+        statechart.transitions.reserve(statechart.transitions.size() + transition_specs.size());
+        std::move(transition_specs.begin(), transition_specs.end(), std::back_inserter(statechart.transitions));
+    }
+};
+
+}  // namespace sismicpp
+
+#endif  // INCLUDE
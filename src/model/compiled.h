@@ -0,0 +1,656 @@
+#ifndef INCLUDE_SISMICPP_MODEL_COMPILED
+#define INCLUDE_SISMICPP_MODEL_COMPILED
+
+#include "model/elements.h"
+#include "model/kinds.h"
+#include "model/statechart.h"
+#include "model/symbols.h"
+#include "exceptions.h"
+#include "utilities.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace sismicpp {
+
+// A state id is also the symbol of the state's name.
+using state_id = symbol_id;
+using transition_id = std::uint32_t;
+
+constexpr state_id no_state = no_symbol;
+
+struct CompiledTransition {
+    transition_id id;
+    state_id source;
+    state_id target = no_state;
+    symbol_id event = no_symbol;
+    const Transition* transition;
+
+    // Plan of an external transition: the ancestor-or-self of the source just below the LCA,
+    // whose active subtree is exited, and the states entered from below the LCA down to the target.
+    state_id exit_root = no_state;
+    Range<state_id> entry_path = {};
+
+    bool is_internal() const {
+        return target == no_state;
+    }
+};
+
+// Immutable, integer-indexed view of a validated StateChart.
+// State ids are assigned in depth-first pre-order from the root (children in insertion order),
+// transition ids follow the order of StateChart::transitions.
+// State names are interned first, so that a state id is its symbol; event names follow.
+struct CompiledStateChart {
+private:
+    StateChart statechart;
+
+    SymbolTable symbols = {};
+    size_t state_count = 0;
+    // State data in struct-of-arrays form, indexed by state id.
+    std::vector<const State*> states = {};
+    std::vector<StateKind> kinds = {};
+    std::vector<kind_flags> flags = {};
+    std::vector<state_id> parents = {};
+    std::vector<state_id> initials = {};
+    std::vector<on_entryexit_func> on_entries = {};
+    std::vector<on_entryexit_func> on_exits = {};
+    std::vector<std::uint32_t> ranks = {};
+    std::vector<std::uint32_t> children_offsets = {};
+    std::vector<state_id> children_ids = {};
+    std::vector<state_id> subtree_ends = {};
+
+    // Default-entry closures: the states entered, in order, after a state is entered without history.
+    std::vector<std::uint32_t> closure_offsets = {};
+    std::vector<state_id> closure_ids = {};
+    std::vector<CompiledTransition> transitions = {};
+    std::vector<state_id> entry_paths = {};
+
+    // Dispatch index: for each event symbol, and for eventless transitions, the candidate transitions
+    // in selection order (deepest source first, then source name, then priority, then declaration).
+    std::vector<std::uint32_t> dispatch_offsets = {};
+    std::vector<transition_id> dispatch_ids = {};
+    std::vector<transition_id> eventless_ids = {};
+
+    // Adjacency index: for each state, the transitions from it and to it in declaration order
+    // (internal transitions go to their source), and the distinct events of the transitions from it.
+    std::vector<std::uint32_t> source_offsets = {};
+    std::vector<transition_id> source_ids = {};
+    std::vector<std::uint32_t> target_offsets = {};
+    std::vector<transition_id> target_ids = {};
+    std::vector<std::uint32_t> source_event_offsets = {};
+    std::vector<symbol_id> source_event_ids = {};
+
+    // Hierarchy index: depth per state, proper ancestors packed nearest-first,
+    // and an Euler tour with a sparse table of its shallowest states for constant-time LCA.
+    std::vector<std::uint32_t> depths = {};
+    std::vector<std::uint32_t> ancestors_offsets = {};
+    std::vector<state_id> ancestors_ids = {};
+    std::vector<std::uint32_t> euler_first = {};
+    std::vector<std::uint8_t> euler_log = {};
+    std::vector<std::vector<state_id>> euler_table = {};
+
+    static StateKind kind_of(const State& state) {
+        if (state.is_compound_state()) {
+            return StateKind::compound;
+        } else if (state.is_orthogonal_state()) {
+            return StateKind::orthogonal;
+        } else if (state.is_shallow_history_state()) {
+            return StateKind::shallow_history;
+        } else if (state.is_deep_history_state()) {
+            return StateKind::deep_history;
+        } else if (state.is_final_state()) {
+            return StateKind::final;
+        }
+        return StateKind::basic;
+    }
+
+    void compile_states() {
+        auto root = statechart.get_root();
+        if (root == "") {
+            return;
+        }
+
+        std::vector<std::string> to_visit = {root};
+        while (!to_visit.empty()) {
+            auto name = std::move(to_visit.back());
+            to_visit.pop_back();
+
+            auto& children = statechart.children.at(name);
+            for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                to_visit.push_back(*it);
+            }
+
+            symbols.intern(name);
+        }
+
+        auto size = state_count = symbols.size();
+        states.reserve(size);
+        kinds.reserve(size);
+        flags.reserve(size);
+        parents.reserve(size);
+        initials.reserve(size);
+        on_entries.reserve(size);
+        on_exits.reserve(size);
+        children_offsets.reserve(size + 1);
+
+        for (state_id id = 0; id < size; ++id) {
+            auto& name = symbols.name_for(id);
+            auto& state = statechart.state_for(name);
+            states.push_back(&state);
+            kinds.push_back(kind_of(state));
+            flags.push_back(sismicpp::flags_for(kinds.back()));
+            on_entries.push_back(state.on_entry);
+            on_exits.push_back(state.on_exit);
+
+            auto parent = statechart.parent_for(name);
+            parents.push_back(id_for(parent));
+
+            if (state.is_compound_state()) {
+                initials.push_back(id_for(static_cast<const CompoundState&>(state).initial));
+            } else if (state.is_history_state()) {
+                initials.push_back(id_for(static_cast<const HistoryState&>(state).memory));
+            } else {
+                initials.push_back(no_state);
+            }
+
+            children_offsets.push_back(static_cast<std::uint32_t>(children_ids.size()));
+            for (auto&& child : statechart.children.at(name)) {
+                children_ids.push_back(id_for(child));
+            }
+        }
+        children_offsets.push_back(static_cast<std::uint32_t>(children_ids.size()));
+
+        std::vector<state_id> by_name(size);
+        for (state_id id = 0; id < size; ++id) {
+            by_name[id] = id;
+        }
+        std::sort(by_name.begin(), by_name.end(), [this] (state_id first, state_id second) {
+            return symbols.name_for(first) < symbols.name_for(second);
+        });
+
+        ranks.resize(size);
+        for (std::uint32_t rank = 0; rank < size; ++rank) {
+            ranks[by_name[rank]] = rank;
+        }
+    }
+
+    void compile_hierarchy() {
+        auto size = state_count;
+
+        // Pre-order ids guarantee that a parent is indexed before its children.
+        size_t ancestors_count = 0;
+        depths.reserve(size);
+        for (state_id id = 0; id < size; ++id) {
+            auto parent = parents[id];
+            depths.push_back(parent == no_state ? 1 : depths[parent] + 1);
+            ancestors_count += depths.back() - 1;
+        }
+
+        ancestors_offsets.reserve(size + 1);
+        ancestors_ids.reserve(ancestors_count);
+        for (state_id id = 0; id < size; ++id) {
+            ancestors_offsets.push_back(static_cast<std::uint32_t>(ancestors_ids.size()));
+            if (parents[id] != no_state) {
+                ancestors_ids.push_back(parents[id]);
+                auto parent_ancestors = ancestors_for(parents[id]);
+                ancestors_ids.insert(ancestors_ids.end(), parent_ancestors.begin(), parent_ancestors.end());
+            }
+        }
+        ancestors_offsets.push_back(static_cast<std::uint32_t>(ancestors_ids.size()));
+
+        // With pre-order ids, the descendants of a state are exactly the ids in (id, subtree_end).
+        subtree_ends.resize(size);
+        for (auto id = size; id-- > 0;) {
+            auto children = children_for(static_cast<state_id>(id));
+            subtree_ends[id] = children.empty() ? static_cast<state_id>(id + 1) : subtree_ends[children[children.size() - 1]];
+        }
+
+        if (size == 0) {
+            return;
+        }
+
+        std::vector<state_id> tour;
+        tour.reserve(2 * size - 1);
+        euler_first.resize(size);
+        std::vector<std::pair<state_id, std::uint32_t>> stack = {{get_root(), 0}};
+        while (!stack.empty()) {
+            auto& top = stack.back();
+            if (top.second == 0) {
+                euler_first[top.first] = static_cast<std::uint32_t>(tour.size());
+            }
+            tour.push_back(top.first);
+
+            auto children = children_for(top.first);
+            if (top.second < children.size()) {
+                auto child = children[top.second++];
+                stack.push_back({child, 0});
+            } else {
+                stack.pop_back();
+            }
+        }
+
+        euler_log.assign(tour.size() + 1, 0);
+        for (size_t i = 2; i <= tour.size(); ++i) {
+            euler_log[i] = euler_log[i / 2] + 1;
+        }
+
+        euler_table.push_back(std::move(tour));
+        for (size_t level = 1; (size_t{1} << level) <= euler_table[0].size(); ++level) {
+            auto& previous = euler_table[level - 1];
+            auto half = size_t{1} << (level - 1);
+            std::vector<state_id> row(euler_table[0].size() - (size_t{1} << level) + 1);
+            for (size_t i = 0; i < row.size(); ++i) {
+                auto first = previous[i];
+                auto second = previous[i + half];
+                row[i] = depths[first] <= depths[second] ? first : second;
+            }
+            euler_table.push_back(std::move(row));
+        }
+    }
+
+    // Closures follow the order of iterative stabilization: an orthogonal state enters all its children
+    // (by name) before completing each of them in turn, a compound state enters and completes its initial state.
+    // A closure ends with the first history state it enters, since resolving it depends on the memory.
+    void compile_closures() {
+        auto size = state_count;
+        std::vector<std::vector<state_id>> closures(size);
+        std::vector<bool> truncated(size, false);
+
+        // Children have larger pre-order ids than their parent, so their closures are known first.
+        for (auto id = size; id-- > 0;) {
+            auto& closure = closures[id];
+            auto complete = [&] (state_id state) {
+                closure.push_back(state);
+                if (is_history(state)) {
+                    return false;
+                }
+                closure.insert(closure.end(), closures[state].begin(), closures[state].end());
+                return !truncated[state];
+            };
+
+            if (is_compound(static_cast<state_id>(id))) {
+                if (initials[id] != no_state) {
+                    truncated[id] = !complete(initials[id]);
+                }
+            } else if (is_orthogonal(static_cast<state_id>(id))) {
+                auto children = children_for(static_cast<state_id>(id));
+                std::vector<state_id> by_rank(children.begin(), children.end());
+                std::sort(by_rank.begin(), by_rank.end(), [this] (state_id first, state_id second) {
+                    return ranks[first] < ranks[second];
+                });
+
+                closure = by_rank;
+                for (auto&& child : by_rank) {
+                    if (is_history(child)) {
+                        truncated[id] = true;
+                        break;
+                    }
+                    closure.insert(closure.end(), closures[child].begin(), closures[child].end());
+                    if (truncated[child]) {
+                        truncated[id] = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        closure_offsets.reserve(size + 1);
+        for (auto&& closure : closures) {
+            closure_offsets.push_back(static_cast<std::uint32_t>(closure_ids.size()));
+            closure_ids.insert(closure_ids.end(), closure.begin(), closure.end());
+        }
+        closure_offsets.push_back(static_cast<std::uint32_t>(closure_ids.size()));
+    }
+
+    void compile_transitions() {
+        transitions.reserve(statechart.transitions.size());
+        for (auto&& transition : statechart.transitions) {
+            transitions.push_back({
+                .id=static_cast<transition_id>(transitions.size()),
+                .source=id_for(transition.source),
+                .target=id_for(transition.target),
+                .event=transition.is_eventless() ? no_symbol : symbols.intern(transition.event),
+                .transition=&transition
+            });
+        }
+    }
+
+    void compile_plans() {
+        std::vector<std::uint32_t> entry_offsets;
+        entry_offsets.reserve(transitions.size() + 1);
+        for (auto&& transition : transitions) {
+            entry_offsets.push_back(static_cast<std::uint32_t>(entry_paths.size()));
+            if (transition.is_internal()) {
+                continue;
+            }
+
+            auto lca = least_common_ancestor(transition.source, transition.target);
+            auto lca_depth = lca == no_state ? 0 : depths[lca];
+            transition.exit_root = ancestor_at_depth(transition.source, lca_depth + 1);
+
+            auto to_ancestors = ancestors_for(transition.target);
+            auto entered_count = depths[transition.target] - lca_depth;
+            for (auto i = entered_count - 1; i-- > 0;) {
+                entry_paths.push_back(to_ancestors[i]);
+            }
+            entry_paths.push_back(transition.target);
+        }
+        entry_offsets.push_back(static_cast<std::uint32_t>(entry_paths.size()));
+
+        for (auto&& transition : transitions) {
+            transition.entry_path = {
+                entry_paths.data() + entry_offsets[transition.id],
+                entry_paths.data() + entry_offsets[transition.id + 1]
+            };
+        }
+    }
+
+    void compile_dispatch() {
+        auto selection_order = [this] (transition_id first, transition_id second) {
+            auto& t1 = transitions[first];
+            auto& t2 = transitions[second];
+            if (t1.source != t2.source) {
+                if (depths[t1.source] != depths[t2.source]) {
+                    return depths[t1.source] > depths[t2.source];
+                }
+                return ranks[t1.source] < ranks[t2.source];
+            }
+            if (t1.transition->priority != t2.transition->priority) {
+                return t1.transition->priority > t2.transition->priority;
+            }
+            return first < second;
+        };
+
+        std::vector<std::vector<transition_id>> buckets(symbols.size());
+        for (auto&& transition : transitions) {
+            if (transition.event == no_symbol) {
+                eventless_ids.push_back(transition.id);
+            } else {
+                buckets[transition.event].push_back(transition.id);
+            }
+        }
+
+        std::sort(eventless_ids.begin(), eventless_ids.end(), selection_order);
+        dispatch_offsets.reserve(buckets.size() + 1);
+        dispatch_ids.reserve(transitions.size() - eventless_ids.size());
+        for (auto&& bucket : buckets) {
+            std::sort(bucket.begin(), bucket.end(), selection_order);
+            dispatch_offsets.push_back(static_cast<std::uint32_t>(dispatch_ids.size()));
+            dispatch_ids.insert(dispatch_ids.end(), bucket.begin(), bucket.end());
+        }
+        dispatch_offsets.push_back(static_cast<std::uint32_t>(dispatch_ids.size()));
+    }
+
+    void compile_adjacency() {
+        auto target_of = [] (const CompiledTransition& transition) {
+            return transition.is_internal() ? transition.source : transition.target;
+        };
+
+        // Counting sort by source and by target, which keeps the declaration order within a state.
+        source_offsets.assign(state_count + 1, 0);
+        target_offsets.assign(state_count + 1, 0);
+        for (auto&& transition : transitions) {
+            ++source_offsets[transition.source + 1];
+            ++target_offsets[target_of(transition) + 1];
+        }
+        for (size_t id = 0; id < state_count; ++id) {
+            source_offsets[id + 1] += source_offsets[id];
+            target_offsets[id + 1] += target_offsets[id];
+        }
+
+        source_ids.resize(transitions.size());
+        target_ids.resize(transitions.size());
+        std::vector<std::uint32_t> next_source(source_offsets.begin(), source_offsets.end() - 1);
+        std::vector<std::uint32_t> next_target(target_offsets.begin(), target_offsets.end() - 1);
+        for (auto&& transition : transitions) {
+            source_ids[next_source[transition.source]++] = transition.id;
+            target_ids[next_target[target_of(transition)]++] = transition.id;
+        }
+
+        source_event_offsets.reserve(state_count + 1);
+        for (size_t id = 0; id < state_count; ++id) {
+            auto first = source_event_ids.size();
+            source_event_offsets.push_back(static_cast<std::uint32_t>(first));
+            for (auto i = source_offsets[id]; i < source_offsets[id + 1]; ++i) {
+                auto event = transitions[source_ids[i]].event;
+                if (event != no_symbol) {
+                    source_event_ids.push_back(event);
+                }
+            }
+            std::sort(source_event_ids.begin() + first, source_event_ids.end());
+            source_event_ids.erase(std::unique(source_event_ids.begin() + first, source_event_ids.end()), source_event_ids.end());
+        }
+        source_event_offsets.push_back(static_cast<std::uint32_t>(source_event_ids.size()));
+    }
+
+public:
+    explicit CompiledStateChart(StateChart statechart_) :
+    statechart(std::move(statechart_)) {
+        statechart.validate();
+        compile_states();
+        compile_hierarchy();
+        compile_closures();
+        compile_transitions();
+        compile_plans();
+        compile_dispatch();
+        compile_adjacency();
+    }
+
+    CompiledStateChart(const CompiledStateChart&) = delete;
+    CompiledStateChart& operator=(const CompiledStateChart&) = delete;
+
+    const StateChart& get_statechart() const {
+        return statechart;
+    }
+
+    const SymbolTable& get_symbols() const {
+        return symbols;
+    }
+
+    size_t size() const {
+        return state_count;
+    }
+
+    state_id get_root() const {
+        return state_count == 0 ? no_state : 0;
+    }
+
+    state_id id_for(const std::string& name) const {
+        auto id = symbols.find(name);
+        return id < state_count ? id : no_state;
+    }
+
+    const std::string& name_for(state_id id) const {
+        return symbols.name_for(id);
+    }
+
+    // Symbol of a state or event name, no_symbol if the statechart does not mention it.
+    symbol_id symbol_for(const std::string& name) const {
+        return symbols.find(name);
+    }
+
+    const State& state_for(state_id id) const {
+        return *states[id];
+    }
+
+    StateKind kind_for(state_id id) const {
+        return kinds[id];
+    }
+
+    kind_flags flags_for(state_id id) const {
+        return flags[id];
+    }
+
+    bool is_compound(state_id id) const {
+        return flags[id] & kind_flag::compound;
+    }
+
+    bool is_orthogonal(state_id id) const {
+        return flags[id] & kind_flag::orthogonal;
+    }
+
+    bool is_composite(state_id id) const {
+        return flags[id] & kind_flag::composite;
+    }
+
+    bool is_history(state_id id) const {
+        return flags[id] & kind_flag::history;
+    }
+
+    bool is_deep_history(state_id id) const {
+        return flags[id] & kind_flag::deep_history;
+    }
+
+    bool is_final(state_id id) const {
+        return flags[id] & kind_flag::final;
+    }
+
+    on_entryexit_func on_entry_for(state_id id) const {
+        return on_entries[id];
+    }
+
+    on_entryexit_func on_exit_for(state_id id) const {
+        return on_exits[id];
+    }
+
+    state_id parent_for(state_id id) const {
+        return parents[id];
+    }
+
+    // Initial state of a compound state, or initial memory of a history state.
+    state_id initial_for(state_id id) const {
+        return initials[id];
+    }
+
+    // Position of the state's name in lexicographic order, used for deterministic tie-breaking.
+    std::uint32_t rank_for(state_id id) const {
+        return ranks[id];
+    }
+
+    Range<state_id> children_for(state_id id) const {
+        return {children_ids.data() + children_offsets[id], children_ids.data() + children_offsets[id + 1]};
+    }
+
+    // Pre-order interval [id, end) covering the state and all of its descendants.
+    Interval<state_id> subtree_for(state_id id) const {
+        return {id, subtree_ends[id]};
+    }
+
+    Interval<state_id> descendants_for(state_id id) const {
+        return {id + 1, subtree_ends[id]};
+    }
+
+    bool is_descendant(state_id id, state_id ancestor) const {
+        return ancestor < id and id < subtree_ends[ancestor];
+    }
+
+    // States entered, in order, to complete the default entry of the state; empty for basic and history states.
+    Range<state_id> closure_for(state_id id) const {
+        return {closure_ids.data() + closure_offsets[id], closure_ids.data() + closure_offsets[id + 1]};
+    }
+
+    size_t depth_for(state_id id) const {
+        return depths[id];
+    }
+
+    // Proper ancestors of the state, nearest first.
+    Range<state_id> ancestors_for(state_id id) const {
+        return {ancestors_ids.data() + ancestors_offsets[id], ancestors_ids.data() + ancestors_offsets[id + 1]};
+    }
+
+    // Ancestor-or-self of the state that lies at the given depth (the root has depth 1).
+    state_id ancestor_at_depth(state_id id, size_t depth) const {
+        auto state_depth = depths[id];
+        if (depth == state_depth) {
+            return id;
+        } else if (depth == 0 or depth > state_depth) {
+            return no_state;
+        }
+        return ancestors_ids[ancestors_offsets[id] + state_depth - depth - 1];
+    }
+
+    // Deepest state that is an ancestor-or-self of both states.
+    state_id lowest_common_ancestor(state_id first, state_id second) const {
+        auto begin = euler_first[first];
+        auto end = euler_first[second];
+        if (begin > end) {
+            std::swap(begin, end);
+        }
+
+        auto level = euler_log[end - begin + 1];
+        auto candidate_first = euler_table[level][begin];
+        auto candidate_second = euler_table[level][end - (std::uint32_t{1} << level) + 1];
+        return depths[candidate_first] <= depths[candidate_second] ? candidate_first : candidate_second;
+    }
+
+    // Deepest state that is a proper ancestor of both states, no_state if there is none.
+    state_id least_common_ancestor(state_id first, state_id second) const {
+        first = parents[first];
+        second = parents[second];
+        if (first == no_state or second == no_state) {
+            return no_state;
+        }
+        return lowest_common_ancestor(first, second);
+    }
+
+    const std::vector<CompiledTransition>& get_transitions() const {
+        return transitions;
+    }
+
+    const CompiledTransition& transition_for(transition_id id) const {
+        return transitions[id];
+    }
+
+    // Transitions from the state, in declaration order.
+    Range<transition_id> transitions_from(state_id id) const {
+        return {source_ids.data() + source_offsets[id], source_ids.data() + source_offsets[id + 1]};
+    }
+
+    // Transitions to the state, in declaration order. Internal transitions go to their source.
+    Range<transition_id> transitions_to(state_id id) const {
+        return {target_ids.data() + target_offsets[id], target_ids.data() + target_offsets[id + 1]};
+    }
+
+    // Distinct events of the transitions from the state, by symbol.
+    Range<symbol_id> events_from(state_id id) const {
+        return {source_event_ids.data() + source_event_offsets[id], source_event_ids.data() + source_event_offsets[id + 1]};
+    }
+
+    // Adds to ret, which spans the symbols, the events of the transitions from any of the states.
+    template <typename States>
+    void events_for(const States& states, Bitset& ret) const {
+        for (auto&& id : states) {
+            for (auto&& event : events_from(static_cast<state_id>(id))) {
+                ret.set(event);
+            }
+        }
+    }
+
+    // Events that the states, typically a configuration, can react to, as a set of symbols.
+    template <typename States>
+    Bitset events_for(const States& states) const {
+        Bitset ret(symbols.size());
+        events_for(states, ret);
+        return ret;
+    }
+
+    // Transitions triggered by the event, in selection order. This is also the per-event index.
+    Range<transition_id> transitions_for_event(symbol_id event) const {
+        if (event == no_symbol) {
+            return {nullptr, nullptr};
+        }
+        return {dispatch_ids.data() + dispatch_offsets[event], dispatch_ids.data() + dispatch_offsets[event + 1]};
+    }
+
+    // Eventless transitions, in selection order.
+    Range<transition_id> eventless_transitions() const {
+        return {eventless_ids.data(), eventless_ids.data() + eventless_ids.size()};
+    }
+};
+
+}  // namespace sismicpp
+
+#endif  // INCLUDE
@@ -1,11 +1,21 @@
 #ifndef INCLUDE_SISMICPP_MODEL_EVENTS
 #define INCLUDE_SISMICPP_MODEL_EVENTS
 
+#include "model/pool.h"
+#include "model/symbols.h"
+
+#include <cstdint>
 #include <string>
 #include <memory>
 
 namespace sismicpp {
 
+enum class EventKind : std::uint8_t {
+    external,
+    internal,
+    meta
+};
+
 struct Event {
     std::string name;
     double delay = 0;
@@ -14,30 +24,162 @@ struct Event {
     Event(std::string name) : name(std::move(name)) {}
     Event(const char* name) : name(name) {}
 
-    virtual bool is_internal_event() const {
-        return false;
+    // Tells the dynamic type, so that events are downcast with static_pointer_cast(). Unlike a data member,
+    // it cannot go wrong when a derived event is copied into an Event.
+    virtual EventKind get_kind() const {
+        return EventKind::external;
+    }
+
+    bool is_internal_event() const {
+        return get_kind() == EventKind::internal;
+    }
+
+    bool is_meta_event() const {
+        return get_kind() == EventKind::meta;
     }
 
     virtual ~Event() {}
 };
 
+// Handle on a queued or sent event. Cancelling it discards the event if it was not consumed yet,
+// and copies of a handle share the same event.
+struct EventHandle {
+    std::shared_ptr<bool> cancelled = nullptr;
+
+    static EventHandle create() {
+        return {std::make_shared<bool>(false)};
+    }
+
+    static EventHandle create(EventPool* pool) {
+        return {make_pooled<bool>(pool, false)};
+    }
+
+    bool valid() const {
+        return cancelled != nullptr;
+    }
+
+    bool is_cancelled() const {
+        return cancelled and *cancelled;
+    }
+
+    void cancel() const {
+        if (cancelled) {
+            *cancelled = true;
+        }
+    }
+};
+
 struct InternalEvent : Event {
-    bool is_internal_event() const override {
-        return true;
+    // Returned by the send() of the context that created the event.
+    EventHandle handle = {};
+
+    EventKind get_kind() const override {
+        return EventKind::internal;
     }
 
     explicit InternalEvent(Event&& event) : Event(std::move(event)) {}
 };
 
+// Meta-events raised by the interpreters, and custom ones sent through notify().
+enum class MetaEventKind : std::uint8_t {
+    step_started,
+    step_ended,
+    event_consumed,
+    event_sent,
+    state_entered,
+    state_exited,
+    transition_processed,
+    custom
+};
+
+inline const char* name_for(MetaEventKind kind) {
+    switch (kind) {
+        case MetaEventKind::step_started: return "step started";
+        case MetaEventKind::step_ended: return "step ended";
+        case MetaEventKind::event_consumed: return "event consumed";
+        case MetaEventKind::event_sent: return "event sent";
+        case MetaEventKind::state_entered: return "state entered";
+        case MetaEventKind::state_exited: return "state exited";
+        case MetaEventKind::transition_processed: return "transition processed";
+        case MetaEventKind::custom: break;
+    }
+    return "";
+}
+
+// Set of meta-event kinds, one bit per kind.
+using MetaEventMask = std::uint32_t;
+
+constexpr MetaEventMask all_meta_events = ~MetaEventMask{0};
+
+constexpr MetaEventMask mask_for(MetaEventKind kind) {
+    return MetaEventMask{1} << static_cast<unsigned>(kind);
+}
+
 struct MetaEvent : Event {
+    // Listeners dispatch on the kind; the name is kept for display.
+    MetaEventKind kind = MetaEventKind::custom;
     double time = 0;
-    std::string state = "";
-    std::string source = "";
-    std::string target = "";
+    symbol_id state = no_symbol;
+    symbol_id source = no_symbol;
+    symbol_id target = no_symbol;
+    const SymbolTable* symbols = nullptr;
     std::shared_ptr<const Event> event = nullptr;
 
+    MetaEvent(MetaEventKind kind, double time) : Event(sismicpp::name_for(kind)), kind(kind), time(time) {}
+    MetaEvent(MetaEventKind kind, double time, const SymbolTable& symbols) :
+    Event(sismicpp::name_for(kind)), kind(kind), time(time), symbols(&symbols) {}
+    // Custom meta-events.
     MetaEvent(std::string name, double time) : Event(std::move(name)), time(time) {}
     explicit MetaEvent(Event&& event) : Event(std::move(event)) {}
+
+    EventKind get_kind() const override {
+        return EventKind::meta;
+    }
+
+    // Names are resolved on demand, an empty name stands for no state.
+    const std::string& get_state() const {
+        return name_for(state);
+    }
+
+    const std::string& get_source() const {
+        return name_for(source);
+    }
+
+    const std::string& get_target() const {
+        return name_for(target);
+    }
+
+private:
+    const std::string& name_for(symbol_id id) const {
+        static const std::string none = "";
+        return id == no_symbol or !symbols ? none : symbols->name_for(id);
+    }
+};
+
+// Built-in meta-events, reused once their listeners released them, so that raising one allocates nothing and
+// does not build its name again.
+struct MetaEventSlots {
+private:
+    std::shared_ptr<MetaEvent> slots[static_cast<size_t>(MetaEventKind::custom)] = {};
+
+public:
+    // The kind must not be custom.
+    std::shared_ptr<MetaEvent> acquire(EventPool* pool, MetaEventKind kind, double time, const SymbolTable& symbols) {
+        auto& slot = slots[static_cast<size_t>(kind)];
+        if (slot and slot.use_count() == 1) {
+            slot->delay = 0;
+            slot->data = nullptr;
+            slot->time = time;
+            slot->state = no_symbol;
+            slot->source = no_symbol;
+            slot->target = no_symbol;
+            slot->symbols = &symbols;
+            slot->event = nullptr;
+        } else {
+            slot = make_pooled<MetaEvent>(pool, kind, time, symbols);
+        }
+        return slot;
+    }
 };
 
 }  // namespace sismicpp
@@ -0,0 +1,51 @@
+#ifndef INCLUDE_SISMICPP_MODEL_KINDS
+#define INCLUDE_SISMICPP_MODEL_KINDS
+
+#include <cstdint>
+
+namespace sismicpp {
+
+enum class StateKind : std::uint8_t {
+    basic,
+    compound,
+    orthogonal,
+    shallow_history,
+    deep_history,
+    final
+};
+
+// Properties of a state kind as bits, so that checking for a family of kinds is a single mask test.
+using kind_flags = std::uint8_t;
+
+namespace kind_flag {
+
+constexpr kind_flags compound = 1 << 0;
+constexpr kind_flags orthogonal = 1 << 1;
+constexpr kind_flags composite = 1 << 2;
+constexpr kind_flags history = 1 << 3;
+constexpr kind_flags deep_history = 1 << 4;
+constexpr kind_flags final = 1 << 5;
+
+}  // namespace kind_flag
+
+constexpr kind_flags flags_for(StateKind kind) {
+    switch (kind) {
+    case StateKind::compound:
+        return kind_flag::compound | kind_flag::composite;
+    case StateKind::orthogonal:
+        return kind_flag::orthogonal | kind_flag::composite;
+    case StateKind::shallow_history:
+        return kind_flag::history;
+    case StateKind::deep_history:
+        return kind_flag::history | kind_flag::deep_history;
+    case StateKind::final:
+        return kind_flag::final;
+    case StateKind::basic:
+        break;
+    }
+    return 0;
+}
+
+}  // namespace sismicpp
+
+#endif  // INCLUDE
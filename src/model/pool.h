@@ -0,0 +1,182 @@
+#ifndef INCLUDE_SISMICPP_MODEL_POOL
+#define INCLUDE_SISMICPP_MODEL_POOL
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sismicpp {
+
+// Counted in blocks, oversized allocations included.
+struct EventPoolStats {
+    size_t in_use = 0;
+    size_t high_water = 0;
+    size_t capacity = 0;
+    size_t slabs = 0;
+};
+
+// Slab allocator for events and their handles, through std::allocate_shared(): each allocation is a single
+// block holding both the control block and the event. Blocks are carved from slabs in size classes
+// of 16 bytes and go back to a free list when the last reference is released, so that a steady flow of events
+// reuses the same blocks. Slabs are only freed with the pool.
+// Events may outlive the owner of the pool, which is then deleted with the last of them, and may be released
+// from any thread, hence the lock.
+struct EventPool {
+    struct Release {
+        void operator()(EventPool* pool) const {
+            pool->release();
+        }
+    };
+
+private:
+    static constexpr size_t granularity = 16;
+    static constexpr size_t class_count = 16;
+    static constexpr size_t blocks_per_slab = 64;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    mutable std::mutex mutex = {};
+    FreeBlock* free_lists[class_count] = {};
+    std::vector<std::unique_ptr<unsigned char[]>> slabs = {};
+    EventPoolStats stats = {};
+    bool released = false;
+
+    EventPool() = default;
+
+    static size_t class_for(size_t bytes) {
+        return (std::max(bytes, size_t{1}) - 1) / granularity;
+    }
+
+    void add_slab(size_t size_class) {
+        auto block_size = (size_class + 1) * granularity;
+        slabs.emplace_back(new unsigned char[block_size * blocks_per_slab]);
+        auto slab = slabs.back().get();
+        for (size_t i = blocks_per_slab; i-- > 0;) {
+            auto block = reinterpret_cast<FreeBlock*>(slab + i * block_size);
+            block->next = free_lists[size_class];
+            free_lists[size_class] = block;
+        }
+        stats.capacity += blocks_per_slab;
+        ++stats.slabs;
+    }
+
+    void release() {
+        bool unused;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            released = true;
+            unused = stats.in_use == 0;
+        }
+        if (unused) {
+            delete this;
+        }
+    }
+
+public:
+    using Owner = std::unique_ptr<EventPool, Release>;
+
+    static Owner create() {
+        return Owner{new EventPool()};
+    }
+
+    EventPool(const EventPool&) = delete;
+    EventPool& operator=(const EventPool&) = delete;
+
+    void* allocate(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.high_water = std::max(stats.high_water, ++stats.in_use);
+
+        auto size_class = class_for(bytes);
+        if (size_class >= class_count) {
+            return ::operator new(bytes);
+        }
+        if (!free_lists[size_class]) {
+            add_slab(size_class);
+        }
+        auto block = free_lists[size_class];
+        free_lists[size_class] = block->next;
+        return block;
+    }
+
+    void deallocate(void* pointer, size_t bytes) {
+        bool unused;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            unused = --stats.in_use == 0 and released;
+
+            auto size_class = class_for(bytes);
+            if (size_class >= class_count) {
+                ::operator delete(pointer);
+            } else {
+                auto block = static_cast<FreeBlock*>(pointer);
+                block->next = free_lists[size_class];
+                free_lists[size_class] = block;
+            }
+        }
+        if (unused) {
+            delete this;
+        }
+    }
+
+    EventPoolStats get_stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    // Starts measuring the high-water mark from the blocks in use.
+    void reset_high_water() {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.high_water = stats.in_use;
+    }
+};
+
+template <typename T>
+struct PoolAllocator {
+    using value_type = T;
+
+    EventPool* pool;
+
+    explicit PoolAllocator(EventPool* pool) : pool(pool) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : pool(other.pool) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(pool->allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        pool->deallocate(pointer, count * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const {
+        return pool == other.pool;
+    }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const {
+        return pool != other.pool;
+    }
+};
+
+// Falls back to std::make_shared() without a pool. T may be const.
+template <typename T, typename... Args>
+std::shared_ptr<T> make_pooled(EventPool* pool, Args&&... args) {
+    if (!pool) {
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+    using allocator = PoolAllocator<typename std::remove_const<T>::type>;
+    return std::allocate_shared<T>(allocator(pool), std::forward<Args>(args)...);
+}
+
+}  // namespace sismicpp
+
+#endif  // INCLUDE
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <memory>
 #include <algorithm>
 
@@ -30,13 +31,10 @@ struct StateChart {
     children{{"", {}}},
     transitions{} {}
 
+    // The root is the only child of "", which add_state() keeps up to date.
     std::string get_root() const {
-        for (const auto& pair : parent) {
-            if (pair.second == "") {
-                return pair.first;
-            }
-        }
-        return "";
+        auto it = children.find("");
+        return it == children.end() or it->second.empty() ? "" : it->second.front();
     }
 
     std::vector<std::string> get_states() const {
@@ -76,51 +74,68 @@ struct StateChart {
         return ancestors;
     }
 
-    std::vector<std::string> descendants_for(std::string name) const {
-        std::vector<std::string> descendants;
-        std::vector<std::string> states_to_consider = {std::move(name)};
-        while (!states_to_consider.empty()) {
-            name = std::move(states_to_consider.front());
-            states_to_consider.erase(states_to_consider.begin());
-
-            for (auto&& child : children.at(name)) {
-                states_to_consider.push_back(child);
-                descendants.push_back(child);
-            }
+    std::vector<std::string> descendants_for(const std::string& name) const {
+        std::vector<std::string> descendants = children.at(name);
+        for (size_t i = 0; i < descendants.size(); ++i) {
+            auto& grandchildren = children.at(descendants[i]);
+            descendants.insert(descendants.end(), grandchildren.begin(), grandchildren.end());
         }
 
         return descendants;
     }
 
     size_t depth_for(const std::string& name) const {
-        return ancestors_for(name).size() + 1;
+        size_t depth = 1;
+        for (auto curr_parent = &parent.at(name); *curr_parent != ""; curr_parent = &parent.at(*curr_parent)) {
+            ++depth;
+        }
+        return depth;
     }
 
     std::string least_common_ancestor(const std::string& name_first, const std::string& name_second) const {
-        auto s1_anc = ancestors_for(name_first);
-        auto s2_anc = ancestors_for(name_second);
-        for (auto&& state : s1_anc) {
-            if (std::find(s2_anc.begin(), s2_anc.end(), state) != s2_anc.end()) {
-                return state;
-            }
+        const std::string* s1 = &parent.at(name_first);
+        const std::string* s2 = &parent.at(name_second);
+        if (*s1 == "" or *s2 == "") {
+            return "";
+        }
+
+        auto d1 = depth_for(*s1);
+        auto d2 = depth_for(*s2);
+        for (; d1 > d2; --d1) {
+            s1 = &parent.at(*s1);
+        }
+        for (; d2 > d1; --d2) {
+            s2 = &parent.at(*s2);
+        }
+        while (*s1 != *s2) {
+            s1 = &parent.at(*s1);
+            s2 = &parent.at(*s2);
         }
 
-        return "";
+        return *s1;
     }
 
     template <typename Iterable>
     std::vector<std::string> leaf_for(const Iterable& names_it) const {
-        std::vector<std::string> leaves;
         std::vector<std::string> names;
         for (auto&& name : names_it) {
             names.push_back(name);
         }
 
+        // A name is not a leaf as soon as one of the other names lies below it.
+        std::set<std::string> sorted_names(names.begin(), names.end());
+        std::set<std::string> inner_names;
+        for (auto&& name : sorted_names) {
+            for (auto curr_parent = &parent.at(name); *curr_parent != ""; curr_parent = &parent.at(*curr_parent)) {
+                if (sorted_names.count(*curr_parent) and !inner_names.insert(*curr_parent).second) {
+                    break;
+                }
+            }
+        }
+
+        std::vector<std::string> leaves;
         for (auto&& name : names) {
-            auto descendants = descendants_for(name);
-            if (std::all_of(descendants.begin(), descendants.end(), [&names] (auto&& descendant) {
-                    return std::find(names.begin(), names.end(), descendant) == names.end();
-                })) {
+            if (!inner_names.count(name)) {
                 leaves.push_back(name);
             }
         }
@@ -192,23 +207,23 @@ struct StateChart {
         return ret;
     }
 
+    // Distinct events of the transitions from the states, sorted. CompiledStateChart indexes them.
     std::vector<std::string> events_for(const std::vector<std::string>& states) const {
-        std::vector<std::string> ret;
-        for (auto&& state : states) {
-            for (auto&& transition : transitions_from(state)) {
-                if (transition->event != "") {
-                    ret.push_back(transition->event);
-                }
+        std::set<std::string> sources(states.begin(), states.end());
+        std::set<std::string> ret;
+        for (auto&& transition : transitions) {
+            if (transition.event != "" and sources.count(transition.source)) {
+                ret.insert(transition.event);
             }
         }
-        return ret;
+        return {ret.begin(), ret.end()};
     }
 
     std::vector<std::string> events_for(const std::string& state) const {
-        if (name == "") {
+        if (state == "") {
             return events_for(get_states());
         } else {
-            return events_for(std::vector<std::string>{name});
+            return events_for(std::vector<std::string>{state});
         }
     }
 
@@ -287,8 +302,7 @@ struct StateChart {
                     throw statechart_error("Initial state '" + compound_state->initial + "' of state '" + compound_state->name + "' does not exist");
                 }
 
-                auto children = children_for(compound_state->name);
-                if (std::find(children.begin(), children.end(), compound_state->initial) == children.end()) {
+                if (parent.at(compound_state->initial) != compound_state->name) {
                     throw statechart_error("Initial state '" + compound_state->initial + "' of state '" + compound_state->name + "' must be a child state");
                 }
             }
@@ -313,8 +327,7 @@ struct StateChart {
                     throw statechart_error("Initial memory of '" + memory + "' of state '" + history_state->name + "' does not exist");
                 }
 
-                auto children = children_for(parent_for(history_state->name));
-                if (std::find(children.begin(), children.end(), memory) == children.end()) {
+                if (parent.at(memory) != parent.at(history_state->name)) {
                     throw statechart_error("Initial memory of '" + memory + "' of state '" + history_state->name + "' must be a parent's child");
                 }
             }
@@ -3,6 +3,8 @@
 
 #include "model/events.h"
 #include "model/elements.h"
+#include "model/compiled.h"
+#include "utilities.h"
 
 #include <vector>
 #include <string>
@@ -23,6 +25,43 @@ struct MacroStep {
     std::vector<MicroStep> steps;
 };
 
+// Micro step as seen by the visitor of Interpreter::execute(), only valid during the call: states are compiled ids,
+// whose names are given by CompiledStateChart::name_for(), and sent events must be copied to be kept.
+struct MicroStepView {
+    double time = 0;
+    const Event* event = nullptr;
+    const Transition* transition = nullptr;
+    Range<state_id> entered_states = {};
+    Range<state_id> exited_states = {};
+    Range<std::shared_ptr<const Event>> sent_events = {};
+};
+
+// Visitor of Interpreter::execute() that ignores the steps, which are then only applied.
+struct DiscardSteps {
+    void operator()(const MicroStepView&) const {}
+};
+
+constexpr DiscardSteps discard_steps = {};
+
+// Macro steps executed for a batch of events, with totals over all of them.
+struct BatchResult {
+    std::vector<MacroStep> macro_steps = {};
+    size_t consumed_events = 0;
+    size_t processed_transitions = 0;
+    size_t sent_events = 0;
+};
+
+// Outcome of Interpreter::execute_for() and execute_until(), which stop between macro steps.
+struct ExecutionReport {
+    size_t macro_steps = 0;
+    // The bound was reached before the interpreter ran out of macro steps, so that more may be pending
+    // even without queued events, through eventless transitions.
+    bool interrupted = false;
+    // Events left in the queues, delayed ones included, and whether one of them is due.
+    size_t queued_events = 0;
+    bool has_due_events = false;
+};
+
 }  // namespace sismicpp
 
 #endif  // INCLUDE
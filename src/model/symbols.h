@@ -0,0 +1,52 @@
+#ifndef INCLUDE_SISMICPP_MODEL_SYMBOLS
+#define INCLUDE_SISMICPP_MODEL_SYMBOLS
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sismicpp {
+
+using symbol_id = std::uint32_t;
+
+constexpr symbol_id no_symbol = std::numeric_limits<symbol_id>::max();
+
+// Interned names, numbered densely in insertion order.
+struct SymbolTable {
+private:
+    std::vector<std::string> names = {};
+    std::unordered_map<std::string, symbol_id> ids = {};
+
+public:
+    symbol_id intern(const std::string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+
+        auto id = static_cast<symbol_id>(names.size());
+        names.push_back(name);
+        ids.emplace(name, id);
+        return id;
+    }
+
+    // Symbol of an interned name, no_symbol otherwise.
+    symbol_id find(const std::string& name) const {
+        auto it = ids.find(name);
+        return it == ids.end() ? no_symbol : it->second;
+    }
+
+    const std::string& name_for(symbol_id id) const {
+        return names[id];
+    }
+
+    size_t size() const {
+        return names.size();
+    }
+};
+
+}  // namespace sismicpp
+
+#endif  // INCLUDE
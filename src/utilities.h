@@ -2,6 +2,9 @@
 #define INCLUDE_SISMICPP_UTILITIES
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <map>
 #include <vector>
 
@@ -29,6 +32,229 @@ auto sorted_groupby(const It& it, KeyFunc&& key_func, bool reverse) {
     return ret;
 }
 
+// Non-owning view over a contiguous run of values.
+template <typename T>
+struct Range {
+    const T* first = nullptr;
+    const T* last = nullptr;
+
+    const T* begin() const {
+        return first;
+    }
+
+    const T* end() const {
+        return last;
+    }
+
+    size_t size() const {
+        return static_cast<size_t>(last - first);
+    }
+
+    bool empty() const {
+        return first == last;
+    }
+
+    const T& operator[](size_t index) const {
+        return first[index];
+    }
+};
+
+// Half-open run of consecutive integral values [first, last).
+template <typename T>
+struct Interval {
+    T first = 0;
+    T last = 0;
+
+    struct iterator {
+        T value;
+
+        T operator*() const {
+            return value;
+        }
+
+        iterator& operator++() {
+            ++value;
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const {
+            return value == other.value;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return value != other.value;
+        }
+    };
+
+    iterator begin() const {
+        return {first};
+    }
+
+    iterator end() const {
+        return {last};
+    }
+
+    size_t size() const {
+        return static_cast<size_t>(last - first);
+    }
+
+    bool empty() const {
+        return first == last;
+    }
+
+    bool contains(T value) const {
+        return first <= value and value < last;
+    }
+};
+
+// Dynamically sized bitset over dense ids, with word-parallel operations and
+// non-allocating iteration over its set bits.
+struct Bitset {
+    using word_type = std::uint64_t;
+    static constexpr size_t word_bits = 64;
+
+    struct iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const size_t*;
+        using reference = size_t;
+
+        const Bitset* bitset;
+        size_t position;
+        size_t last;
+
+        size_t operator*() const {
+            return position;
+        }
+
+        iterator& operator++() {
+            position = bitset->find_next(position + 1, last);
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const {
+            return position == other.position;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return position != other.position;
+        }
+    };
+
+    // Set bits of a bitset, restricted to [first, last).
+    struct View {
+        const Bitset* bitset;
+        size_t first;
+        size_t last;
+
+        iterator begin() const {
+            return {bitset, bitset->find_next(first, last), last};
+        }
+
+        iterator end() const {
+            return {bitset, last, last};
+        }
+    };
+
+    Bitset() = default;
+
+    explicit Bitset(size_t size) :
+    words((size + word_bits - 1) / word_bits, 0),
+    bits(size) {}
+
+    size_t size() const {
+        return bits;
+    }
+
+    bool test(size_t index) const {
+        return (words[index / word_bits] >> (index % word_bits)) & 1;
+    }
+
+    void set(size_t index) {
+        words[index / word_bits] |= word_type{1} << (index % word_bits);
+    }
+
+    void reset(size_t index) {
+        words[index / word_bits] &= ~(word_type{1} << (index % word_bits));
+    }
+
+    void clear() {
+        std::fill(words.begin(), words.end(), 0);
+    }
+
+    bool any() const {
+        return std::any_of(words.begin(), words.end(), [] (word_type word) { return word != 0; });
+    }
+
+    size_t count() const {
+        size_t ret = 0;
+        for (auto&& word : words) {
+            ret += static_cast<size_t>(__builtin_popcountll(word));
+        }
+        return ret;
+    }
+
+    Bitset& operator&=(const Bitset& other) {
+        for (size_t i = 0; i < words.size(); ++i) {
+            words[i] &= other.words[i];
+        }
+        return *this;
+    }
+
+    Bitset& operator|=(const Bitset& other) {
+        for (size_t i = 0; i < words.size(); ++i) {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+
+    bool operator==(const Bitset& other) const {
+        return bits == other.bits and words == other.words;
+    }
+
+    bool operator!=(const Bitset& other) const {
+        return !(*this == other);
+    }
+
+    // Index of the first set bit in [from, last), or last if there is none.
+    size_t find_next(size_t from, size_t last) const {
+        if (from >= last) {
+            return last;
+        }
+
+        auto word = from / word_bits;
+        auto last_word = (last + word_bits - 1) / word_bits;
+        auto current = words[word] & (~word_type{0} << (from % word_bits));
+        while (true) {
+            if (current) {
+                auto position = word * word_bits + static_cast<size_t>(__builtin_ctzll(current));
+                return position < last ? position : last;
+            }
+            if (++word >= last_word) {
+                return last;
+            }
+            current = words[word];
+        }
+    }
+
+    View ones() const {
+        return {this, 0, bits};
+    }
+
+    View ones(size_t first, size_t last) const {
+        return {this, first, last};
+    }
+
+    const std::vector<word_type>& get_words() const {
+        return words;
+    }
+
+private:
+    std::vector<word_type> words = {};
+    size_t bits = 0;
+};
+
 }  // namespace sismicpp
 
 #endif  // INCLUDE
\ No newline at end of file
@@ -0,0 +1,275 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "interpreter/default.h"
+
+namespace {
+
+size_t allocations = 0;
+
+}  // namespace
+
+// GCC cannot see that the replaced operator new allocates with malloc, so it flags every free below.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    ++allocations;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+// History, guards, an internal transition, an action sending an event, and a state name too long to be stored inline.
+sismicpp::StateChart make_statechart() {
+    using namespace sismicpp;
+
+    StateChart statechart{"Allocations"};
+    statechart.add_state(CompoundState("root", "on"), "");
+        statechart.add_state(CompoundState("on", "idle"), "root");
+            statechart.add_state(BasicState("idle"), "on");
+            statechart.add_state(BasicState("busy with a long running job"), "on");
+            statechart.add_state(ShallowHistoryState("on.H", "idle"), "on");
+        statechart.add_state(BasicState("off"), "root");
+        statechart.add_transition({
+            .source="idle",
+            .event="job",
+            .guard=[] (auto, GuardContext& guard_context) { return guard_context.after(0); },
+            .target="busy with a long running job",
+            .action=[] (auto, ActionContext& action_context) { action_context.send(Event("done")); }
+        });
+        statechart.add_transition({
+            .source="busy with a long running job",
+            .event="done",
+            .target="idle"
+        });
+        statechart.add_transition({
+            .source="on",
+            .event="tick",
+            .guard=[] (auto, GuardContext& guard_context) { return guard_context.idle(0); }
+        });
+        statechart.add_transition({
+            .source="on",
+            .event="power",
+            .target="off"
+        });
+        statechart.add_transition({
+            .source="off",
+            .event="power",
+            .target="on.H"
+        });
+
+    return statechart;
+}
+
+// Allocations made by a number of rounds of events, after a round to warm up.
+template <typename Execute>
+size_t count_allocations(sismicpp::Interpreter& interp, size_t rounds, Execute execute) {
+    auto run = [&] {
+        for (auto&& name : {"job", "tick", "power", "tick", "power", "job"}) {
+            interp.queue(name);
+            execute();
+        }
+    };
+
+    interp.execute();
+    run();
+    auto before = allocations;
+    for (size_t i = 0; i < rounds; ++i) {
+        run();
+    }
+    return allocations - before;
+}
+
+size_t count_allocations(sismicpp::Interpreter& interp, size_t rounds) {
+    sismicpp::MacroStep macro_step;
+    return count_allocations(interp, rounds, [&] {
+        while (interp.execute_once(macro_step)) {}
+    });
+}
+
+struct Listener : sismicpp::Attachable {
+    size_t count = 0;
+
+    void operator()(std::shared_ptr<const sismicpp::MetaEvent>) override {
+        ++count;
+    }
+};
+
+}  // namespace
+
+TEST_CASE( "Executing into a reused macro step does not allocate", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto compiled = std::make_shared<const CompiledStateChart>(make_statechart());
+
+    Interpreter interp{compiled, nullptr};
+    REQUIRE( count_allocations(interp, 100) == 0 );
+    REQUIRE( interp.get_configuration() == std::vector<std::string>({"root", "on", "idle"}) );
+
+    Interpreter listened{compiled, nullptr};
+    Listener listener;
+    listened.attach(&listener);
+    REQUIRE( count_allocations(listened, 100) == 0 );
+    REQUIRE( listener.count > 0 );
+
+    Interpreter cached{compiled, nullptr};
+    cached.set_cache(std::make_shared<MacroStepCache>(compiled));
+    REQUIRE( count_allocations(cached, 100) == 0 );
+    REQUIRE( cached.get_cache()->get_hits() > 0 );
+}
+
+TEST_CASE( "Reused macro steps match the returned ones", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto compiled = std::make_shared<const CompiledStateChart>(make_statechart());
+    Interpreter expected{compiled, nullptr};
+    Interpreter reused{compiled, nullptr};
+
+    auto names = [] (const std::vector<std::shared_ptr<const Event>>& events) {
+        std::vector<std::string> ret;
+        for (auto&& event : events) {
+            ret.push_back(event->name);
+        }
+        return ret;
+    };
+
+    MacroStep macro_step;
+    for (auto&& name : {"", "job", "tick", "power", "unknown", "power", "job", "power"}) {
+        if (*name) {
+            expected.queue(name);
+            reused.queue(name);
+        }
+        while (true) {
+            auto returned = expected.execute_once();
+            REQUIRE( reused.execute_once(macro_step) == (returned != nullptr) );
+            if (!returned) {
+                REQUIRE( macro_step.steps.empty() );
+                break;
+            }
+            REQUIRE( macro_step.steps.size() == returned->steps.size() );
+            for (size_t i = 0; i < returned->steps.size(); ++i) {
+                auto& step = macro_step.steps[i];
+                auto& returned_step = returned->steps[i];
+                REQUIRE( (step.event ? step.event->name : "") == (returned_step.event ? returned_step.event->name : "") );
+                REQUIRE( step.transition == returned_step.transition );
+                REQUIRE( step.entered_states == returned_step.entered_states );
+                REQUIRE( step.exited_states == returned_step.exited_states );
+                REQUIRE( names(step.sent_events) == names(returned_step.sent_events) );
+            }
+        }
+        REQUIRE( reused.get_configuration() == expected.get_configuration() );
+    }
+}
+
+TEST_CASE( "Executing with a visitor does not allocate", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto compiled = std::make_shared<const CompiledStateChart>(make_statechart());
+
+    Interpreter discarded{compiled, nullptr};
+    REQUIRE( count_allocations(discarded, 100, [&] { discarded.execute(discard_steps); }) == 0 );
+    REQUIRE( discarded.get_configuration() == std::vector<std::string>({"root", "on", "idle"}) );
+
+    Interpreter visited{compiled, nullptr};
+    size_t entered = 0;
+    size_t sent = 0;
+    auto visitor = [&] (const MicroStepView& step) {
+        entered += step.entered_states.size();
+        sent += step.sent_events.size();
+    };
+    REQUIRE( count_allocations(visited, 100, [&] { visited.execute(visitor); }) == 0 );
+    REQUIRE( entered > 0 );
+    // Two jobs per round, warm-up included.
+    REQUIRE( sent == 2 * 101 );
+}
+
+TEST_CASE( "Visited steps match the returned ones", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto compiled = std::make_shared<const CompiledStateChart>(make_statechart());
+    Interpreter expected{compiled, nullptr};
+    Interpreter visited{compiled, nullptr};
+
+    auto names = [&] (Range<state_id> ids) {
+        std::vector<std::string> ret;
+        for (auto&& id : ids) {
+            ret.push_back(compiled->name_for(id));
+        }
+        return ret;
+    };
+
+    for (auto&& name : {"", "job", "tick", "power", "unknown", "power", "job", "power"}) {
+        if (*name) {
+            expected.queue(name);
+            visited.queue(name);
+        }
+        while (true) {
+            auto returned = expected.execute_once();
+            size_t i = 0;
+            auto executed = visited.execute_once([&] (const MicroStepView& step) {
+                REQUIRE( returned );
+                REQUIRE( i < returned->steps.size() );
+                auto& returned_step = returned->steps[i++];
+                REQUIRE( step.time == returned->time );
+                REQUIRE( (step.event ? step.event->name : "") == (returned_step.event ? returned_step.event->name : "") );
+                REQUIRE( step.transition == returned_step.transition );
+                REQUIRE( names(step.entered_states) == returned_step.entered_states );
+                REQUIRE( names(step.exited_states) == returned_step.exited_states );
+                REQUIRE( step.sent_events.size() == returned_step.sent_events.size() );
+                for (size_t j = 0; j < step.sent_events.size(); ++j) {
+                    REQUIRE( step.sent_events[j]->name == returned_step.sent_events[j]->name );
+                }
+            });
+            REQUIRE( executed == (returned != nullptr) );
+            if (!returned) {
+                break;
+            }
+            REQUIRE( i == returned->steps.size() );
+        }
+        REQUIRE( visited.get_configuration() == expected.get_configuration() );
+    }
+}
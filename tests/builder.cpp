@@ -60,3 +60,50 @@ TEST_CASE( "Enter initial states", "[sismicpp]" ) {
     REQUIRE( (*transitions[0]).event == "toggle" );
     REQUIRE( (*transitions[0]).target == "Off" );
 }
+
+TEST_CASE( "Build nested states in the order they are written", "[sismicpp]" ) {
+    using namespace sismicpp;
+    using namespace sismicpp::builder;
+
+    auto statechart = build_statechart(
+        name("Nested"),
+        root_state(
+            initial("on"),
+            state(
+                initial("H"),
+                state(name("H"), type("shallow history"), memory("idle")),
+                state(name("idle"), transition(target("busy"), event("go"))),
+                parallel_state(
+                    state(name("left")),
+                    state(name("right")),
+                    transition(event("stop"), target("idle")),
+                    name("busy")
+                ),
+                name("on")
+            ),
+            state(name("done"), type("final")),
+            transition(event("quit"), target("done")),
+            name("root")
+        )
+    );
+
+    REQUIRE( statechart.get_root() == "root" );
+    REQUIRE( statechart.children_for("root") == std::vector<std::string>{"on", "done"} );
+    REQUIRE( statechart.children_for("on") == std::vector<std::string>{"H", "idle", "busy"} );
+    REQUIRE( statechart.children_for("busy") == std::vector<std::string>{"left", "right"} );
+    REQUIRE( statechart.state_for("busy").is_orthogonal_state() );
+    REQUIRE( statechart.state_for("H").is_shallow_history_state() );
+    REQUIRE( static_cast<HistoryState&>(statechart.state_for("H")).memory == "idle" );
+    REQUIRE( statechart.state_for("done").is_final_state() );
+
+    // Transitions of a state come before the ones of its descendants.
+    REQUIRE( statechart.transitions.size() == 3 );
+    REQUIRE( statechart.transitions[0].source == "root" );
+    REQUIRE( statechart.transitions[1].source == "idle" );
+    REQUIRE( statechart.transitions[1].event == "go" );
+    REQUIRE( statechart.transitions[2].source == "busy" );
+
+    REQUIRE_THROWS_AS( build_statechart(root_state(name("root"), type("final"), state(name("0")))), statechart_error );
+    REQUIRE_THROWS_AS( build_statechart(root_state(name("root"), initial("1"), state(name("0")))), statechart_error );
+    REQUIRE_THROWS_AS( type("unknown"), sismic_error );
+}
@@ -0,0 +1,161 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+#include "model/bulk.h"
+#include "model/compiled.h"
+
+static sismicpp::StateChart make_statechart() {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "0"), "");
+        statechart.add_state(CompoundState("0", "01"), "root");
+            statechart.add_state(OrthogonalState("01"), "0");
+                statechart.add_state(CompoundState("010", "0100"), "01");
+                    statechart.add_state(BasicState("0100"), "010");
+                    statechart.add_state(BasicState("0101"), "010");
+                statechart.add_state(BasicState("011"), "01");
+            statechart.add_state(ShallowHistoryState("0H", "01"), "0");
+        statechart.add_state(FinalState("00"), "root");
+    statechart.add_transition({
+        .source="0100",
+        .target="00",
+        .event="done"
+    });
+    statechart.add_transition({
+        .source="011",
+        .event="tick"
+    });
+
+    return statechart;
+}
+
+// Same chart as make_statechart(), with children given before their parents.
+static sismicpp::BulkBuilder make_builder() {
+    using namespace sismicpp;
+
+    std::vector<BulkStateSpec> states;
+    states.push_back({std::make_unique<BasicState>("0100"), "010"});
+    states.push_back({std::make_unique<BasicState>("0101"), "010"});
+    states.push_back({std::make_unique<CompoundState>("010", "0100"), "01"});
+    states.push_back({std::make_unique<BasicState>("011"), "01"});
+    states.push_back({std::make_unique<OrthogonalState>("01"), "0"});
+
+    BulkBuilder builder{"MyStateChart"};
+    builder.add_states(std::move(states))
+        .add_state(ShallowHistoryState("0H", "01"), "0")
+        .add_state(CompoundState("0", "01"), "root")
+        .add_state(FinalState("00"), "root")
+        .add_state(CompoundState("root", "0"), "")
+        .add_transitions({{.source="0100", .target="00", .event="done"}})
+        .add_transition({.source="011", .event="tick"});
+
+    return builder;
+}
+
+TEST_CASE( "Bulk statechart matches the incremental one", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto expected = make_statechart();
+    auto builder = make_builder();
+    auto statechart = builder.build();
+
+    REQUIRE( statechart.name == expected.name );
+    REQUIRE( statechart.get_root() == "root" );
+    REQUIRE( statechart.get_states() == expected.get_states() );
+    REQUIRE( statechart.parent == expected.parent );
+    for (auto&& name : expected.get_states()) {
+        auto children = statechart.children_for(name);
+        auto expected_children = expected.children_for(name);
+        std::sort(children.begin(), children.end());
+        std::sort(expected_children.begin(), expected_children.end());
+        REQUIRE( children == expected_children );
+        REQUIRE( statechart.state_for(name).is_compound_state() == expected.state_for(name).is_compound_state() );
+        REQUIRE( statechart.state_for(name).is_history_state() == expected.state_for(name).is_history_state() );
+    }
+    REQUIRE( statechart.transitions.size() == 2 );
+    REQUIRE( statechart.events_for() == expected.events_for() );
+    REQUIRE_NOTHROW( statechart.validate() );
+
+    CompiledStateChart compiled{std::move(statechart)};
+    REQUIRE( compiled.size() == 9 );
+
+    auto& report = builder.get_report();
+    REQUIRE( report.states == 9 );
+    REQUIRE( report.transitions == 2 );
+    REQUIRE( report.build_time >= 0 );
+    REQUIRE( report.validation_time >= 0 );
+
+    // The builder starts over after build().
+    REQUIRE( builder.build().states.empty() );
+}
+
+TEST_CASE( "Bulk statechart errors", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto rejects = [] (auto add) {
+        auto builder = make_builder();
+        add(builder);
+        REQUIRE_THROWS_AS( builder.build(), statechart_error );
+    };
+
+    rejects([] (BulkBuilder& builder) { builder.add_state(BasicState("0101"), "root"); });
+    rejects([] (BulkBuilder& builder) { builder.add_state(BasicState(""), "root"); });
+    rejects([] (BulkBuilder& builder) { builder.add_state(BasicState("1"), "unknown"); });
+    rejects([] (BulkBuilder& builder) { builder.add_state(BasicState("1"), ""); });
+    rejects([] (BulkBuilder& builder) { builder.add_state(BasicState("1"), "0101"); });
+    rejects([] (BulkBuilder& builder) { builder.add_state(DeepHistoryState("1H", ""), "01"); });
+    rejects([] (BulkBuilder& builder) {
+        builder.add_state(CompoundState("a", "b"), "b").add_state(CompoundState("b", "a"), "a");
+    });
+    rejects([] (BulkBuilder& builder) { builder.add_state(CompoundState("1", "0100"), "root"); });
+    rejects([] (BulkBuilder& builder) {
+        builder.add_state(CompoundState("1", "11"), "root").add_state(ShallowHistoryState("1H", "0100"), "1");
+    });
+    rejects([] (BulkBuilder& builder) { builder.add_transition({.source="unknown"}); });
+    rejects([] (BulkBuilder& builder) { builder.add_transition({.source="00", .target="0"}); });
+    rejects([] (BulkBuilder& builder) { builder.add_transition({.source="0", .target="unknown"}); });
+
+    StateChart statechart{make_builder().build()};
+    REQUIRE_THROWS_AS( statechart.add_state(BasicState("1"), ""), statechart_error );
+}
+
+TEST_CASE( "Bulk build of a large statechart", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    const size_t groups = 1000;
+    const size_t leaves = 100;
+
+    std::vector<BulkStateSpec> states;
+    std::vector<Transition> transitions;
+    states.push_back({std::make_unique<CompoundState>("root", "g0"), ""});
+    for (size_t group = 0; group < groups; ++group) {
+        auto group_name = "g" + std::to_string(group);
+        states.push_back({std::make_unique<CompoundState>(group_name, group_name + ".0"), "root"});
+        for (size_t leaf = 0; leaf < leaves; ++leaf) {
+            auto leaf_name = group_name + "." + std::to_string(leaf);
+            states.push_back({std::make_unique<BasicState>(leaf_name), group_name});
+            transitions.push_back({
+                .source=leaf_name,
+                .target=group_name + "." + std::to_string((leaf + 1) % leaves),
+                .event="next"
+            });
+        }
+        transitions.push_back({.source=group_name, .target="g" + std::to_string((group + 1) % groups), .event="jump"});
+    }
+
+    BulkBuilder builder{"Large"};
+    builder.add_states(std::move(states)).add_transitions(std::move(transitions));
+    auto statechart = builder.build();
+
+    REQUIRE( builder.get_report().states == 1 + groups * (1 + leaves) );
+    REQUIRE( builder.get_report().transitions == groups * (1 + leaves) );
+    REQUIRE( statechart.children_for("root").size() == groups );
+    REQUIRE( statechart.parent_for("g999.99") == "g999" );
+
+    CompiledStateChart compiled{std::move(statechart)};
+    REQUIRE( compiled.size() == 1 + groups * (1 + leaves) );
+}
@@ -0,0 +1,140 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "interpreter/default.h"
+#include "codegen/generator.h"
+#include "codegen/chart.h"
+#include "codegen/alarm_clock.h"
+
+namespace {
+
+struct MetaEventLog : sismicpp::Attachable {
+    std::vector<std::string> entries = {};
+
+    void operator()(std::shared_ptr<const sismicpp::MetaEvent> event) override {
+        entries.push_back(
+            event->name + " " + event->get_state() + " " + event->get_source() + " " + event->get_target() +
+            " " + (event->event ? event->event->name : "")
+        );
+    }
+};
+
+std::vector<std::string> describe(const std::vector<sismicpp::MacroStep>& macro_steps) {
+    std::vector<std::string> ret;
+    for (auto&& macro_step : macro_steps) {
+        ret.push_back("macro step " + std::to_string(macro_step.time));
+        for (auto&& step : macro_step.steps) {
+            std::string description = step.event ? step.event->name : "-";
+            if (step.transition) {
+                description += " " + step.transition->source + "->" + step.transition->target;
+            }
+            for (auto&& state : step.exited_states) {
+                description += " -" + state;
+            }
+            for (auto&& state : step.entered_states) {
+                description += " +" + state;
+            }
+            for (auto&& event : step.sent_events) {
+                description += " !" + event->name;
+            }
+            ret.push_back(description);
+        }
+    }
+    return ret;
+}
+
+}  // namespace
+
+TEST_CASE( "Generated code is up to date", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    CompiledStateChart statechart(codegen_chart::make_statechart());
+    auto generated = codegen::generate_cpp(statechart, codegen_chart::make_symbols(), codegen_chart::make_options());
+
+    std::string path = __FILE__;
+    path = path.substr(0, path.find_last_of("/\\") + 1) + "codegen/alarm_clock.h";
+    std::ifstream file(path);
+    REQUIRE( file );
+    std::stringstream expected;
+    expected << file.rdbuf();
+
+    REQUIRE( generated == expected.str() );
+}
+
+TEST_CASE( "Generate code without meta-events", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto options = codegen_chart::make_options();
+    options.meta_events = false;
+    CompiledStateChart statechart(codegen_chart::make_statechart());
+    auto generated = codegen::generate_cpp(statechart, codegen_chart::make_symbols(), options);
+
+    REQUIRE( generated.find("Machine(context, false)") != std::string::npos );
+    REQUIRE( generated.find("MetaEventKind::state_exited") == std::string::npos );
+    REQUIRE( generated.find("MetaEventKind::step_ended") == std::string::npos );
+
+    // Guards may rely on after() and idle(), so their time provider is still fed.
+    REQUIRE( generated.find("MetaEventKind::state_entered") != std::string::npos );
+}
+
+TEST_CASE( "Generate code for unnamed functions", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    CompiledStateChart statechart(codegen_chart::make_statechart());
+    REQUIRE_NOTHROW( codegen::generate_cpp(statechart, codegen_chart::make_symbols()) );
+    REQUIRE_THROWS_AS( codegen::generate_cpp(statechart, codegen::FunctionSymbols{}), sismic_error );
+}
+
+TEST_CASE( "Generated machine agrees with the interpreter", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    codegen_chart::Context interpreter_context;
+    codegen_chart::Context machine_context;
+    Interpreter interpreter{codegen_chart::make_statechart(), &interpreter_context};
+    codegen_chart::AlarmClock machine{&machine_context};
+
+    MetaEventLog interpreter_log;
+    MetaEventLog machine_log;
+    interpreter.attach(&interpreter_log);
+    machine.attach(&machine_log);
+
+    auto run = [&] (std::vector<std::string> events, double time) {
+        static_cast<SimulatedClock&>(*interpreter.clock).set_time(time);
+        static_cast<SimulatedClock&>(*machine.clock).set_time(time);
+        for (auto&& event : events) {
+            interpreter.queue(event);
+            machine.queue(event);
+        }
+
+        REQUIRE( describe(machine.execute()) == describe(interpreter.execute()) );
+        REQUIRE( machine.get_configuration() == interpreter.get_configuration() );
+        REQUIRE( machine_log.entries == interpreter_log.entries );
+        REQUIRE( machine_context.log == interpreter_context.log );
+        REQUIRE( machine_context.rings == interpreter_context.rings );
+    };
+
+    run({}, 0);
+    REQUIRE( machine.is_active(codegen_chart::AlarmClock::State::off) );
+
+    run({"power", "start", "arm", "start"}, 1);
+    REQUIRE( machine.is_active(codegen_chart::AlarmClock::State::low) );
+    REQUIRE( machine.is_active(codegen_chart::AlarmClock::State::dim) );
+
+    run({"tick", "snooze"}, 2);
+    run({"tick"}, 3.5);
+    run({"tick", "unknown", "snooze"}, 5);
+    REQUIRE( machine.is_active(codegen_chart::AlarmClock::State::idle) );
+
+    run({"start", "tick", "pause", "resume"}, 6);
+    REQUIRE( machine.is_active(codegen_chart::AlarmClock::State::high) );
+    REQUIRE( machine_context.rings > 0 );
+
+    run({"stop", "arm", "arm"}, 8);
+    REQUIRE( machine.is_in_final() );
+    REQUIRE( interpreter.is_in_final() );
+}
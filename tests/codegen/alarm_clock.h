@@ -0,0 +1,983 @@
+// Generated by sismicpp::codegen::generate_cpp from statechart "Alarm clock", do not edit.
+#ifndef INCLUDE_SISMICPP_GENERATED_ALARMCLOCK
+#define INCLUDE_SISMICPP_GENERATED_ALARMCLOCK
+
+#include "codegen/runtime.h"
+#include "codegen/chart.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace codegen_chart {
+
+struct AlarmClock : sismicpp::codegen::Machine {
+    enum class State : std::uint8_t {
+        clock = 0,
+        off = 1,
+        on = 2,
+        H = 3,
+        idle = 4,
+        running = 5,
+        siren = 6,
+        low = 7,
+        high = 8,
+        light = 9,
+        LH = 10,
+        dim = 11,
+        bright = 12,
+        paused = 13,
+        done = 14,
+    };
+
+    enum class EventId : std::uint8_t {
+        off = 1,
+        power = 15,
+        arm = 16,
+        start = 17,
+        tick = 18,
+        ring = 19,
+        stop = 20,
+        snooze = 21,
+        pause = 22,
+        resume = 23,
+    };
+
+    static constexpr std::size_t state_count = 15;
+    static constexpr std::size_t transition_count = 15;
+
+private:
+    sismicpp::Bitset memory[2];
+    bool has_memory[2] = {};
+    sismicpp::Bitset blocked = sismicpp::Bitset(state_count);
+    sismicpp::Bitset snapshot = sismicpp::Bitset(state_count);
+
+public:
+    explicit AlarmClock(void* context = nullptr) :
+    Machine(context, true) {
+        static const char* const names[] = {
+            "clock",
+            "off",
+            "on",
+            "H",
+            "idle",
+            "running",
+            "siren",
+            "low",
+            "high",
+            "light",
+            "LH",
+            "dim",
+            "bright",
+            "paused",
+            "done",
+            "power",
+            "arm",
+            "start",
+            "tick",
+            "ring",
+            "stop",
+            "snooze",
+            "pause",
+            "resume",
+        };
+        for (auto&& name : names) {
+            symbols.intern(name);
+        }
+        configuration = sismicpp::Bitset(state_count);
+        for (auto&& recorded : memory) {
+            recorded = sismicpp::Bitset(state_count);
+        }
+        codegen_chart::preamble(context);
+    }
+
+    using Machine::is_active;
+
+    bool is_active(State state) const {
+        return configuration.test(static_cast<sismicpp::symbol_id>(state));
+    }
+
+    static const sismicpp::Transition& transition_for(std::size_t id) {
+        static const sismicpp::Transition transitions[] = {
+            sismicpp::Transition{"off", "on", "power", nullptr, nullptr, 0},
+            sismicpp::Transition{"idle", "", "arm", nullptr, codegen_chart::arm, 0},
+            sismicpp::Transition{"idle", "running", "start", codegen_chart::is_armed, nullptr, 0},
+            sismicpp::Transition{"idle", "done", "", codegen_chart::is_overloaded, nullptr, 0},
+            sismicpp::Transition{"low", "high", "tick", nullptr, nullptr, 0},
+            sismicpp::Transition{"high", "low", "tick", nullptr, nullptr, 0},
+            sismicpp::Transition{"dim", "bright", "tick", nullptr, nullptr, 0},
+            sismicpp::Transition{"bright", "dim", "tick", codegen_chart::is_ringing, nullptr, 1},
+            sismicpp::Transition{"bright", "bright", "tick", nullptr, nullptr, 0},
+            sismicpp::Transition{"running", "", "ring", nullptr, codegen_chart::ring, 0},
+            sismicpp::Transition{"running", "idle", "stop", nullptr, nullptr, 0},
+            sismicpp::Transition{"running", "idle", "snooze", codegen_chart::has_waited, nullptr, 0},
+            sismicpp::Transition{"on", "paused", "pause", nullptr, nullptr, 0},
+            sismicpp::Transition{"paused", "on", "resume", nullptr, nullptr, 0},
+            sismicpp::Transition{"paused", "done", "off", nullptr, nullptr, 0},
+        };
+        return transitions[id];
+    }
+
+    static const char* name_for(State state) {
+        switch (state) {
+        case State::clock: return "clock";
+        case State::off: return "off";
+        case State::on: return "on";
+        case State::H: return "H";
+        case State::idle: return "idle";
+        case State::running: return "running";
+        case State::siren: return "siren";
+        case State::low: return "low";
+        case State::high: return "high";
+        case State::light: return "light";
+        case State::LH: return "LH";
+        case State::dim: return "dim";
+        case State::bright: return "bright";
+        case State::paused: return "paused";
+        case State::done: return "done";
+        }
+        return "";
+    }
+
+    std::unique_ptr<sismicpp::MacroStep> execute_once() override {
+        raise_step_event(sismicpp::MetaEventKind::step_started);
+        std::vector<sismicpp::MicroStep> steps;
+
+        if (!initialized) {
+            initialized = true;
+            sismicpp::MicroStep step;
+            enter_clock(step);
+            finish_step(step);
+            steps.push_back(std::move(step));
+            stabilize(steps);
+        } else {
+            auto queued = select_event();
+            auto event = queued ? queued->event : nullptr;
+            std::size_t selected[15];
+            auto selected_count = select_transitions(event.get(), queued ? queued->symbol : sismicpp::no_symbol, selected);
+            if (selected_count == 0) {
+                if (event) {
+                    consume_event();
+                    sismicpp::MicroStep step;
+                    step.event = event;
+                    steps.push_back(std::move(step));
+                    stabilize(steps);
+                }
+            } else {
+                if (transition_for(selected[0]).is_eventless()) {
+                    event = nullptr;
+                } else {
+                    consume_event();
+                }
+
+                // Exits are computed against the configuration before any of the selected transitions is processed.
+                const sismicpp::Bitset* active = &configuration;
+                if (selected_count > 1) {
+                    snapshot = configuration;
+                    active = &snapshot;
+                }
+                for (std::size_t i = 0; i < selected_count; ++i) {
+                    apply_transition(selected[i], *active, event, steps);
+                    stabilize(steps);
+                }
+            }
+        }
+
+        std::unique_ptr<sismicpp::MacroStep> macro_step;
+        if (!steps.empty()) {
+            macro_step = std::make_unique<sismicpp::MacroStep>(sismicpp::MacroStep{clock->get_time(), std::move(steps)});
+        }
+        raise_step_event(sismicpp::MetaEventKind::step_ended);
+        return macro_step;
+    }
+
+private:
+    std::size_t select_transitions(const sismicpp::Event* event, sismicpp::symbol_id symbol, std::size_t* selected) {
+        std::size_t count = 0;
+        bool found = false;
+        blocked.clear();
+
+        if (configuration.test(4) and !blocked.test(4)) {
+            found = false;
+            {
+                sismicpp::CppGuardContext guard_context(time_provider, *this, symbols.name_for(4), nullptr);
+                if (codegen_chart::is_overloaded(context, guard_context)) {
+                    selected[count++] = 3;
+                    found = true;
+                }
+            }
+            if (found) {
+                blocked.set(4);
+                blocked.set(2);
+                blocked.set(0);
+            }
+        }
+        if (count == 0 and event) {
+            switch (symbol) {
+            case static_cast<sismicpp::symbol_id>(EventId::off):
+                if (configuration.test(13) and !blocked.test(13)) {
+                    found = false;
+                    selected[count++] = 14;
+                    found = true;
+                    if (found) {
+                        blocked.set(13);
+                        blocked.set(0);
+                    }
+                }
+                break;
+            case static_cast<sismicpp::symbol_id>(EventId::power):
+                if (configuration.test(1) and !blocked.test(1)) {
+                    found = false;
+                    selected[count++] = 0;
+                    found = true;
+                    if (found) {
+                        blocked.set(1);
+                        blocked.set(0);
+                    }
+                }
+                break;
+            case static_cast<sismicpp::symbol_id>(EventId::arm):
+                if (configuration.test(4) and !blocked.test(4)) {
+                    found = false;
+                    selected[count++] = 1;
+                    found = true;
+                    if (found) {
+                        blocked.set(4);
+                        blocked.set(2);
+                        blocked.set(0);
+                    }
+                }
+                break;
+            case static_cast<sismicpp::symbol_id>(EventId::start):
+                if (configuration.test(4) and !blocked.test(4)) {
+                    found = false;
+                    {
+                        sismicpp::CppGuardContext guard_context(time_provider, *this, symbols.name_for(4), event);
+                        if (codegen_chart::is_armed(context, guard_context)) {
+                            selected[count++] = 2;
+                            found = true;
+                        }
+                    }
+                    if (found) {
+                        blocked.set(4);
+                        blocked.set(2);
+                        blocked.set(0);
+                    }
+                }
+                break;
+            case static_cast<sismicpp::symbol_id>(EventId::tick):
+                if (configuration.test(12) and !blocked.test(12)) {
+                    found = false;
+                    {
+                        sismicpp::CppGuardContext guard_context(time_provider, *this, symbols.name_for(12), event);
+                        if (codegen_chart::is_ringing(context, guard_context)) {
+                            selected[count++] = 7;
+                            found = true;
+                        }
+                    }
+                    if (!found) {
+                        selected[count++] = 8;
+                        found = true;
+                    }
+                    if (found) {
+                        blocked.set(12);
+                        blocked.set(9);
+                        blocked.set(5);
+                        blocked.set(2);
+                        blocked.set(0);
+                    }
+                }
+                if (configuration.test(11) and !blocked.test(11)) {
+                    found = false;
+                    selected[count++] = 6;
+                    found = true;
+                    if (found) {
+                        blocked.set(11);
+                        blocked.set(9);
+                        blocked.set(5);
+                        blocked.set(2);
+                        blocked.set(0);
+                    }
+                }
+                if (configuration.test(8) and !blocked.test(8)) {
+                    found = false;
+                    selected[count++] = 5;
+                    found = true;
+                    if (found) {
+                        blocked.set(8);
+                        blocked.set(6);
+                        blocked.set(5);
+                        blocked.set(2);
+                        blocked.set(0);
+                    }
+                }
+                if (configuration.test(7) and !blocked.test(7)) {
+                    found = false;
+                    selected[count++] = 4;
+                    found = true;
+                    if (found) {
+                        blocked.set(7);
+                        blocked.set(6);
+                        blocked.set(5);
+                        blocked.set(2);
+                        blocked.set(0);
+                    }
+                }
+                break;
+            case static_cast<sismicpp::symbol_id>(EventId::ring):
+                if (configuration.test(5) and !blocked.test(5)) {
+                    found = false;
+                    selected[count++] = 9;
+                    found = true;
+                    if (found) {
+                        blocked.set(5);
+                        blocked.set(2);
+                        blocked.set(0);
+                    }
+                }
+                break;
+            case static_cast<sismicpp::symbol_id>(EventId::stop):
+                if (configuration.test(5) and !blocked.test(5)) {
+                    found = false;
+                    selected[count++] = 10;
+                    found = true;
+                    if (found) {
+                        blocked.set(5);
+                        blocked.set(2);
+                        blocked.set(0);
+                    }
+                }
+                break;
+            case static_cast<sismicpp::symbol_id>(EventId::snooze):
+                if (configuration.test(5) and !blocked.test(5)) {
+                    found = false;
+                    {
+                        sismicpp::CppGuardContext guard_context(time_provider, *this, symbols.name_for(5), event);
+                        if (codegen_chart::has_waited(context, guard_context)) {
+                            selected[count++] = 11;
+                            found = true;
+                        }
+                    }
+                    if (found) {
+                        blocked.set(5);
+                        blocked.set(2);
+                        blocked.set(0);
+                    }
+                }
+                break;
+            case static_cast<sismicpp::symbol_id>(EventId::pause):
+                if (configuration.test(2) and !blocked.test(2)) {
+                    found = false;
+                    selected[count++] = 12;
+                    found = true;
+                    if (found) {
+                        blocked.set(2);
+                        blocked.set(0);
+                    }
+                }
+                break;
+            case static_cast<sismicpp::symbol_id>(EventId::resume):
+                if (configuration.test(13) and !blocked.test(13)) {
+                    found = false;
+                    selected[count++] = 13;
+                    found = true;
+                    if (found) {
+                        blocked.set(13);
+                        blocked.set(0);
+                    }
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        (void) found;
+        return count;
+    }
+
+    void apply_transition(std::size_t id, const sismicpp::Bitset& active, std::shared_ptr<const sismicpp::Event> event,
+                          std::vector<sismicpp::MicroStep>& steps) {
+        (void) active;
+        sismicpp::MicroStep step;
+        step.event = event;
+        step.transition = &transition_for(id);
+
+        switch (id) {
+        case 0: {
+            if (active.test(1)) {
+                exit_off(step);
+            }
+            raise_transition_processed(1, 2, event);
+            enter_on(step);
+            break;
+        }
+        case 1: {
+            {
+                sismicpp::CppActionContext action_context(time_provider, *this, event, sent_events, event_pool.get());
+                codegen_chart::arm(context, action_context);
+            }
+            raise_transition_processed(4, sismicpp::no_symbol, event);
+            break;
+        }
+        case 2: {
+            if (active.test(4)) {
+                exit_idle(step);
+            }
+            raise_transition_processed(4, 5, event);
+            enter_running(step);
+            break;
+        }
+        case 3: {
+            if (active.test(9)) {
+                record_history_light();
+            }
+            if (active.test(2)) {
+                record_history_on();
+            }
+            if (active.test(12)) {
+                exit_bright(step);
+            }
+            if (active.test(11)) {
+                exit_dim(step);
+            }
+            if (active.test(10)) {
+                exit_LH(step);
+            }
+            if (active.test(8)) {
+                exit_high(step);
+            }
+            if (active.test(7)) {
+                exit_low(step);
+            }
+            if (active.test(9)) {
+                exit_light(step);
+            }
+            if (active.test(6)) {
+                exit_siren(step);
+            }
+            if (active.test(5)) {
+                exit_running(step);
+            }
+            if (active.test(4)) {
+                exit_idle(step);
+            }
+            if (active.test(3)) {
+                exit_H(step);
+            }
+            if (active.test(2)) {
+                exit_on(step);
+            }
+            raise_transition_processed(4, 14, event);
+            enter_done(step);
+            break;
+        }
+        case 4: {
+            if (active.test(7)) {
+                exit_low(step);
+            }
+            raise_transition_processed(7, 8, event);
+            enter_high(step);
+            break;
+        }
+        case 5: {
+            if (active.test(8)) {
+                exit_high(step);
+            }
+            raise_transition_processed(8, 7, event);
+            enter_low(step);
+            break;
+        }
+        case 6: {
+            if (active.test(11)) {
+                exit_dim(step);
+            }
+            raise_transition_processed(11, 12, event);
+            enter_bright(step);
+            break;
+        }
+        case 7: {
+            if (active.test(12)) {
+                exit_bright(step);
+            }
+            raise_transition_processed(12, 11, event);
+            enter_dim(step);
+            break;
+        }
+        case 8: {
+            if (active.test(12)) {
+                exit_bright(step);
+            }
+            raise_transition_processed(12, 12, event);
+            enter_bright(step);
+            break;
+        }
+        case 9: {
+            {
+                sismicpp::CppActionContext action_context(time_provider, *this, event, sent_events, event_pool.get());
+                codegen_chart::ring(context, action_context);
+            }
+            raise_transition_processed(5, sismicpp::no_symbol, event);
+            break;
+        }
+        case 10: {
+            if (active.test(9)) {
+                record_history_light();
+            }
+            if (active.test(12)) {
+                exit_bright(step);
+            }
+            if (active.test(11)) {
+                exit_dim(step);
+            }
+            if (active.test(10)) {
+                exit_LH(step);
+            }
+            if (active.test(8)) {
+                exit_high(step);
+            }
+            if (active.test(7)) {
+                exit_low(step);
+            }
+            if (active.test(9)) {
+                exit_light(step);
+            }
+            if (active.test(6)) {
+                exit_siren(step);
+            }
+            if (active.test(5)) {
+                exit_running(step);
+            }
+            raise_transition_processed(5, 4, event);
+            enter_idle(step);
+            break;
+        }
+        case 11: {
+            if (active.test(9)) {
+                record_history_light();
+            }
+            if (active.test(12)) {
+                exit_bright(step);
+            }
+            if (active.test(11)) {
+                exit_dim(step);
+            }
+            if (active.test(10)) {
+                exit_LH(step);
+            }
+            if (active.test(8)) {
+                exit_high(step);
+            }
+            if (active.test(7)) {
+                exit_low(step);
+            }
+            if (active.test(9)) {
+                exit_light(step);
+            }
+            if (active.test(6)) {
+                exit_siren(step);
+            }
+            if (active.test(5)) {
+                exit_running(step);
+            }
+            raise_transition_processed(5, 4, event);
+            enter_idle(step);
+            break;
+        }
+        case 12: {
+            if (active.test(9)) {
+                record_history_light();
+            }
+            if (active.test(2)) {
+                record_history_on();
+            }
+            if (active.test(12)) {
+                exit_bright(step);
+            }
+            if (active.test(11)) {
+                exit_dim(step);
+            }
+            if (active.test(10)) {
+                exit_LH(step);
+            }
+            if (active.test(8)) {
+                exit_high(step);
+            }
+            if (active.test(7)) {
+                exit_low(step);
+            }
+            if (active.test(9)) {
+                exit_light(step);
+            }
+            if (active.test(6)) {
+                exit_siren(step);
+            }
+            if (active.test(5)) {
+                exit_running(step);
+            }
+            if (active.test(4)) {
+                exit_idle(step);
+            }
+            if (active.test(3)) {
+                exit_H(step);
+            }
+            if (active.test(2)) {
+                exit_on(step);
+            }
+            raise_transition_processed(2, 13, event);
+            enter_paused(step);
+            break;
+        }
+        case 13: {
+            if (active.test(13)) {
+                exit_paused(step);
+            }
+            raise_transition_processed(13, 2, event);
+            enter_on(step);
+            break;
+        }
+        case 14: {
+            if (active.test(13)) {
+                exit_paused(step);
+            }
+            raise_transition_processed(13, 14, event);
+            enter_done(step);
+            break;
+        }
+        default:
+            break;
+        }
+
+        finish_step(step);
+        steps.push_back(std::move(step));
+    }
+
+    void stabilize(std::vector<sismicpp::MicroStep>& steps) {
+        while (stabilize_once(steps)) {}
+    }
+
+    bool stabilize_once(std::vector<sismicpp::MicroStep>& steps) {
+        sismicpp::MicroStep step;
+        if (configuration.test(10)) {
+            exit_LH(step);
+            if (has_memory[1]) {
+                if (memory[1].test(10)) {
+                    enter_LH(step);
+                }
+                if (memory[1].test(12)) {
+                    enter_bright(step);
+                }
+                if (memory[1].test(11)) {
+                    enter_dim(step);
+                }
+            } else {
+                enter_dim(step);
+            }
+            finish_step(step);
+            steps.push_back(std::move(step));
+            return true;
+        }
+        if (configuration.test(9) and configuration.find_next(10, 13) == 13) {
+            enter_LH(step);
+            finish_step(step);
+            steps.push_back(std::move(step));
+            return true;
+        }
+        if (configuration.test(6) and configuration.find_next(7, 9) == 9) {
+            enter_low(step);
+            finish_step(step);
+            steps.push_back(std::move(step));
+            return true;
+        }
+        if (configuration.test(3)) {
+            exit_H(step);
+            if (has_memory[0]) {
+                if (memory[0].test(3)) {
+                    enter_H(step);
+                }
+                if (memory[0].test(4)) {
+                    enter_idle(step);
+                }
+                if (memory[0].test(5)) {
+                    enter_running(step);
+                }
+                if (memory[0].test(9)) {
+                    enter_light(step);
+                }
+                if (memory[0].test(6)) {
+                    enter_siren(step);
+                }
+                if (memory[0].test(10)) {
+                    enter_LH(step);
+                }
+                if (memory[0].test(12)) {
+                    enter_bright(step);
+                }
+                if (memory[0].test(11)) {
+                    enter_dim(step);
+                }
+                if (memory[0].test(8)) {
+                    enter_high(step);
+                }
+                if (memory[0].test(7)) {
+                    enter_low(step);
+                }
+            } else {
+                enter_idle(step);
+            }
+            finish_step(step);
+            steps.push_back(std::move(step));
+            return true;
+        }
+        if (configuration.test(5) and configuration.find_next(6, 13) == 13) {
+            enter_light(step);
+            enter_siren(step);
+            enter_LH(step);
+            finish_step(step);
+            steps.push_back(std::move(step));
+            return true;
+        }
+        if (configuration.test(14)) {
+            exit_done(step);
+            exit_clock(step);
+            finish_step(step);
+            steps.push_back(std::move(step));
+            return true;
+        }
+        if (configuration.test(2) and configuration.find_next(3, 13) == 13) {
+            enter_H(step);
+            finish_step(step);
+            steps.push_back(std::move(step));
+            return true;
+        }
+        if (configuration.test(0) and configuration.find_next(1, 15) == 15) {
+            enter_off(step);
+            finish_step(step);
+            steps.push_back(std::move(step));
+            return true;
+        }
+        return false;
+    }
+
+    void enter_clock(sismicpp::MicroStep& step) {
+        configuration.set(0);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 0);
+        step.entered_states.push_back(symbols.name_for(0));
+    }
+
+    void exit_clock(sismicpp::MicroStep& step) {
+        configuration.reset(0);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 0);
+        step.exited_states.push_back(symbols.name_for(0));
+    }
+
+    void enter_off(sismicpp::MicroStep& step) {
+        configuration.set(1);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 1);
+        step.entered_states.push_back(symbols.name_for(1));
+    }
+
+    void exit_off(sismicpp::MicroStep& step) {
+        configuration.reset(1);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 1);
+        step.exited_states.push_back(symbols.name_for(1));
+    }
+
+    void enter_on(sismicpp::MicroStep& step) {
+        {
+            sismicpp::CppOnEntryExitContext entryexit_context(time_provider, *this, sent_events, event_pool.get());
+            codegen_chart::enter_on(context, entryexit_context);
+        }
+        configuration.set(2);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 2);
+        step.entered_states.push_back(symbols.name_for(2));
+    }
+
+    void exit_on(sismicpp::MicroStep& step) {
+        {
+            sismicpp::CppOnEntryExitContext entryexit_context(time_provider, *this, sent_events, event_pool.get());
+            codegen_chart::exit_on(context, entryexit_context);
+        }
+        configuration.reset(2);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 2);
+        step.exited_states.push_back(symbols.name_for(2));
+    }
+
+    void enter_H(sismicpp::MicroStep& step) {
+        configuration.set(3);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 3);
+        step.entered_states.push_back(symbols.name_for(3));
+    }
+
+    void exit_H(sismicpp::MicroStep& step) {
+        configuration.reset(3);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 3);
+        step.exited_states.push_back(symbols.name_for(3));
+    }
+
+    void enter_idle(sismicpp::MicroStep& step) {
+        configuration.set(4);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 4);
+        step.entered_states.push_back(symbols.name_for(4));
+    }
+
+    void exit_idle(sismicpp::MicroStep& step) {
+        configuration.reset(4);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 4);
+        step.exited_states.push_back(symbols.name_for(4));
+    }
+
+    void enter_running(sismicpp::MicroStep& step) {
+        configuration.set(5);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 5);
+        step.entered_states.push_back(symbols.name_for(5));
+    }
+
+    void exit_running(sismicpp::MicroStep& step) {
+        configuration.reset(5);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 5);
+        step.exited_states.push_back(symbols.name_for(5));
+    }
+
+    void enter_siren(sismicpp::MicroStep& step) {
+        configuration.set(6);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 6);
+        step.entered_states.push_back(symbols.name_for(6));
+    }
+
+    void exit_siren(sismicpp::MicroStep& step) {
+        configuration.reset(6);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 6);
+        step.exited_states.push_back(symbols.name_for(6));
+    }
+
+    void enter_low(sismicpp::MicroStep& step) {
+        configuration.set(7);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 7);
+        step.entered_states.push_back(symbols.name_for(7));
+    }
+
+    void exit_low(sismicpp::MicroStep& step) {
+        configuration.reset(7);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 7);
+        step.exited_states.push_back(symbols.name_for(7));
+    }
+
+    void enter_high(sismicpp::MicroStep& step) {
+        {
+            sismicpp::CppOnEntryExitContext entryexit_context(time_provider, *this, sent_events, event_pool.get());
+            codegen_chart::enter_high(context, entryexit_context);
+        }
+        configuration.set(8);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 8);
+        step.entered_states.push_back(symbols.name_for(8));
+    }
+
+    void exit_high(sismicpp::MicroStep& step) {
+        configuration.reset(8);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 8);
+        step.exited_states.push_back(symbols.name_for(8));
+    }
+
+    void enter_light(sismicpp::MicroStep& step) {
+        configuration.set(9);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 9);
+        step.entered_states.push_back(symbols.name_for(9));
+    }
+
+    void exit_light(sismicpp::MicroStep& step) {
+        configuration.reset(9);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 9);
+        step.exited_states.push_back(symbols.name_for(9));
+    }
+
+    void enter_LH(sismicpp::MicroStep& step) {
+        configuration.set(10);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 10);
+        step.entered_states.push_back(symbols.name_for(10));
+    }
+
+    void exit_LH(sismicpp::MicroStep& step) {
+        configuration.reset(10);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 10);
+        step.exited_states.push_back(symbols.name_for(10));
+    }
+
+    void enter_dim(sismicpp::MicroStep& step) {
+        configuration.set(11);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 11);
+        step.entered_states.push_back(symbols.name_for(11));
+    }
+
+    void exit_dim(sismicpp::MicroStep& step) {
+        configuration.reset(11);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 11);
+        step.exited_states.push_back(symbols.name_for(11));
+    }
+
+    void enter_bright(sismicpp::MicroStep& step) {
+        configuration.set(12);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 12);
+        step.entered_states.push_back(symbols.name_for(12));
+    }
+
+    void exit_bright(sismicpp::MicroStep& step) {
+        configuration.reset(12);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 12);
+        step.exited_states.push_back(symbols.name_for(12));
+    }
+
+    void enter_paused(sismicpp::MicroStep& step) {
+        configuration.set(13);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 13);
+        step.entered_states.push_back(symbols.name_for(13));
+    }
+
+    void exit_paused(sismicpp::MicroStep& step) {
+        configuration.reset(13);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 13);
+        step.exited_states.push_back(symbols.name_for(13));
+    }
+
+    void enter_done(sismicpp::MicroStep& step) {
+        configuration.set(14);
+        raise_state_event(sismicpp::MetaEventKind::state_entered, 14);
+        step.entered_states.push_back(symbols.name_for(14));
+    }
+
+    void exit_done(sismicpp::MicroStep& step) {
+        configuration.reset(14);
+        raise_state_event(sismicpp::MetaEventKind::state_exited, 14);
+        step.exited_states.push_back(symbols.name_for(14));
+    }
+
+    void record_history_on() {
+        memory[0].clear();
+        for (auto&& state : configuration.ones(3, 13)) {
+            memory[0].set(state);
+        }
+        has_memory[0] = true;
+    }
+
+    void record_history_light() {
+        memory[1].clear();
+        if (configuration.test(10)) {
+            memory[1].set(10);
+        }
+        if (configuration.test(11)) {
+            memory[1].set(11);
+        }
+        if (configuration.test(12)) {
+            memory[1].set(12);
+        }
+        has_memory[1] = true;
+    }
+
+};
+
+}  // namespace codegen_chart
+
+#endif  // INCLUDE
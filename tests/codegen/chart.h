@@ -0,0 +1,130 @@
+#ifndef INCLUDE_SISMICPP_TESTS_CODEGEN_CHART
+#define INCLUDE_SISMICPP_TESTS_CODEGEN_CHART
+
+#include "model/context.h"
+#include "model/statechart.h"
+#include "codegen/generator.h"
+
+#include <string>
+#include <vector>
+
+// Statechart and functions shared by the code generator test and the machine generated from them.
+namespace codegen_chart {
+
+struct Context {
+    std::vector<std::string> log = {};
+    int armed = 0;
+    int rings = 0;
+};
+
+inline void preamble(void* context) {
+    static_cast<Context*>(context)->log.push_back("preamble");
+}
+
+inline void enter_on(void* context, sismicpp::OnEntryExitContext& entryexit_context) {
+    static_cast<Context*>(context)->log.push_back("enter on " + std::to_string(entryexit_context.active("off")));
+}
+
+inline void exit_on(void* context, sismicpp::OnEntryExitContext& entryexit_context) {
+    static_cast<Context*>(context)->log.push_back("exit on");
+    entryexit_context.send("exited");
+}
+
+inline void enter_high(void* context, sismicpp::OnEntryExitContext& entryexit_context) {
+    static_cast<Context*>(context)->log.push_back("enter high");
+    auto ring = sismicpp::Event("ring");
+    ring.delay = 1;
+    entryexit_context.send(ring);
+}
+
+inline bool is_armed(const void* context, sismicpp::GuardContext&) {
+    return static_cast<const Context*>(context)->armed > 0;
+}
+
+inline bool is_overloaded(const void* context, sismicpp::GuardContext&) {
+    return static_cast<const Context*>(context)->armed > 2;
+}
+
+inline bool is_ringing(const void*, sismicpp::GuardContext& guard_context) {
+    return guard_context.active("high");
+}
+
+inline bool has_waited(const void*, sismicpp::GuardContext& guard_context) {
+    return guard_context.after(2);
+}
+
+inline void arm(void* context, sismicpp::ActionContext& action_context) {
+    static_cast<Context*>(context)->log.push_back("arm " + action_context.get_event()->name);
+    ++static_cast<Context*>(context)->armed;
+}
+
+inline void ring(void* context, sismicpp::ActionContext&) {
+    ++static_cast<Context*>(context)->rings;
+}
+
+inline sismicpp::StateChart make_statechart() {
+    using namespace sismicpp;
+
+    StateChart statechart{"Alarm clock"};
+    statechart.preamble = preamble;
+    statechart.add_state(CompoundState("clock", "off"), "");
+        statechart.add_state(BasicState("off"), "clock");
+        statechart.add_state(CompoundState("on", "H", enter_on, exit_on), "clock");
+            statechart.add_state(DeepHistoryState("H", "idle"), "on");
+            statechart.add_state(BasicState("idle"), "on");
+            statechart.add_state(OrthogonalState("running"), "on");
+                statechart.add_state(CompoundState("siren", "low"), "running");
+                    statechart.add_state(BasicState("low"), "siren");
+                    statechart.add_state(BasicState("high", enter_high, nullptr), "siren");
+                statechart.add_state(CompoundState("light", "LH"), "running");
+                    statechart.add_state(ShallowHistoryState("LH", "dim"), "light");
+                    statechart.add_state(BasicState("dim"), "light");
+                    statechart.add_state(BasicState("bright"), "light");
+        statechart.add_state(BasicState("paused"), "clock");
+        statechart.add_state(FinalState("done"), "clock");
+
+    statechart.add_transition({.source="off", .target="on", .event="power"});
+    statechart.add_transition({.source="idle", .event="arm", .action=arm});
+    statechart.add_transition({.source="idle", .target="running", .event="start", .guard=is_armed});
+    statechart.add_transition({.source="idle", .target="done", .guard=is_overloaded});
+    statechart.add_transition({.source="low", .target="high", .event="tick"});
+    statechart.add_transition({.source="high", .target="low", .event="tick"});
+    statechart.add_transition({.source="dim", .target="bright", .event="tick"});
+    statechart.add_transition({.source="bright", .target="dim", .event="tick", .guard=is_ringing, .priority=1});
+    statechart.add_transition({.source="bright", .target="bright", .event="tick"});
+    statechart.add_transition({.source="running", .event="ring", .action=ring});
+    statechart.add_transition({.source="running", .target="idle", .event="stop"});
+    statechart.add_transition({.source="running", .target="idle", .event="snooze", .guard=has_waited});
+    statechart.add_transition({.source="on", .target="paused", .event="pause"});
+    statechart.add_transition({.source="paused", .target="on", .event="resume"});
+    statechart.add_transition({.source="paused", .target="done", .event="off"});
+
+    return statechart;
+}
+
+inline sismicpp::codegen::FunctionSymbols make_symbols() {
+    sismicpp::codegen::FunctionSymbols symbols;
+    symbols.add(preamble, "codegen_chart::preamble")
+           .add(enter_on, "codegen_chart::enter_on")
+           .add(exit_on, "codegen_chart::exit_on")
+           .add(enter_high, "codegen_chart::enter_high")
+           .add(is_armed, "codegen_chart::is_armed")
+           .add(is_overloaded, "codegen_chart::is_overloaded")
+           .add(is_ringing, "codegen_chart::is_ringing")
+           .add(has_waited, "codegen_chart::has_waited")
+           .add(arm, "codegen_chart::arm")
+           .add(ring, "codegen_chart::ring");
+    return symbols;
+}
+
+inline sismicpp::codegen::CppOptions make_options() {
+    sismicpp::codegen::CppOptions options;
+    options.class_name = "AlarmClock";
+    options.name_space = "codegen_chart";
+    options.includes = {"codegen/chart.h"};
+    return options;
+}
+
+}  // namespace codegen_chart
+
+#endif  // INCLUDE
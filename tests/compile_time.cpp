@@ -0,0 +1,236 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+
+#include <string>
+
+#include "compile_time/builder.h"
+#include "compile_time/interpreter.h"
+#include "interpreter/default.h"
+#include "model/builder.h"
+
+namespace {
+
+bool is_armed(const void* context) {
+    return *static_cast<const int*>(context) > 0;
+}
+
+void arm(void* context) {
+    ++*static_cast<int*>(context);
+}
+
+bool is_armed_dynamic(const void* context, sismicpp::GuardContext&) {
+    return is_armed(context);
+}
+
+void arm_dynamic(void* context, sismicpp::ActionContext&) {
+    arm(context);
+}
+
+sismicpp::StateChart make_dynamic_alarm_clock() {
+    using namespace sismicpp::builder;
+    return build_statechart(
+        name("Alarm"),
+        root_state(
+            name("root"),
+            initial("on"),
+            state(
+                name("on"),
+                initial("H"),
+                state(name("H"), type("deep history"), memory("idle")),
+                state(
+                    name("idle"),
+                    transition(event("arm"), action(arm_dynamic)),
+                    transition(event("start"), target("running"), guard(is_armed_dynamic))
+                ),
+                parallel_state(
+                    name("running"),
+                    state(
+                        name("siren"),
+                        initial("low"),
+                        state(name("low"), transition(event("tick"), target("high"))),
+                        state(name("high"), transition(event("tick"), target("low")))
+                    ),
+                    state(
+                        name("light"),
+                        initial("dim"),
+                        state(name("dim"), transition(event("tick"), target("bright"))),
+                        state(name("bright"))
+                    ),
+                    transition(event("stop"), target("idle"))
+                ),
+                transition(event("pause"), target("paused"))
+            ),
+            state(
+                name("paused"),
+                transition(event("resume"), target("on")),
+                transition(event("off"), target("done"))
+            ),
+            state(name("done"), type("final"))
+        )
+    );
+}
+
+using namespace sismicpp::compile_time::builder;
+
+constexpr auto button = build_statechart(
+    name("My Button StateChart"),
+    description("A showcase of statecharts and buttons"),
+    root_state(
+        name("Button"),
+        initial("Off"),
+        state(
+            name("Off"),
+            transition(
+                event("toggle"),
+                target("On")
+            )
+        ),
+        state(
+            name("On"),
+            transition(
+                event("toggle"),
+                target("Off")
+            )
+        )
+    )
+);
+
+static_assert(button.validate(), "invalid statechart");
+static_assert(button.state_count == 3 and button.transition_count == 2, "unexpected table sizes");
+static_assert(button.id_for("Off") == 1 and button.states[1].parent == 0, "states are not in pre-order");
+static_assert(button.event_for("toggle") == 0 and button.event_for("unknown") == sismicpp::compile_time::no_event, "unexpected events");
+
+constexpr auto unknown_target = build_statechart(
+    root_state(name("root"), initial("0"), state(name("0"), transition(target("1"))))
+);
+static_assert(unknown_target.check() == sismicpp::compile_time::ValidationError::unknown_target, "target is not checked");
+
+constexpr auto initial_not_child = build_statechart(
+    root_state(name("root"), initial("01"), state(name("0"), initial("01"), state(name("01"))))
+);
+static_assert(initial_not_child.check() == sismicpp::compile_time::ValidationError::initial_not_child, "initial is not checked");
+
+constexpr auto typed_compound = build_statechart(
+    root_state(name("root"), initial("0"), state(name("0"), type("final"), state(name("01"))))
+);
+static_assert(typed_compound.check() == sismicpp::compile_time::ValidationError::typed_compound_state, "type is not checked");
+
+constexpr auto duplicate = build_statechart(
+    root_state(name("root"), initial("0"), state(name("0")), state(name("0")))
+);
+static_assert(duplicate.check() == sismicpp::compile_time::ValidationError::duplicate_state, "names are not checked");
+
+constexpr auto alarm_clock = build_statechart(
+    name("Alarm"),
+    root_state(
+        name("root"),
+        initial("on"),
+        state(
+            name("on"),
+            initial("H"),
+            state(name("H"), type("deep history"), memory("idle")),
+            state(
+                name("idle"),
+                transition(event("arm"), action(arm)),
+                transition(event("start"), target("running"), guard(is_armed))
+            ),
+            parallel_state(
+                name("running"),
+                state(
+                    name("siren"),
+                    initial("low"),
+                    state(name("low"), transition(event("tick"), target("high"))),
+                    state(name("high"), transition(event("tick"), target("low")))
+                ),
+                state(
+                    name("light"),
+                    initial("dim"),
+                    state(name("dim"), transition(event("tick"), target("bright"))),
+                    state(name("bright"))
+                ),
+                transition(event("stop"), target("idle"))
+            ),
+            transition(event("pause"), target("paused"))
+        ),
+        state(
+            name("paused"),
+            transition(event("resume"), target("on")),
+            transition(event("off"), target("done"))
+        ),
+        state(name("done"), type("final"))
+    )
+);
+
+static_assert(alarm_clock.validate(), "invalid statechart");
+
+}  // namespace
+
+TEST_CASE( "Run a compile-time statechart", "[sismicpp]" ) {
+    using namespace sismicpp::compile_time;
+
+    auto interpreter = make_interpreter(button);
+    interpreter.execute();
+
+    REQUIRE( interpreter.is_active(button.id_for("Button")) );
+    REQUIRE( interpreter.is_active(button.id_for("Off")) );
+
+    constexpr auto toggle = button.event_for("toggle");
+    interpreter.queue(toggle).execute();
+    REQUIRE( interpreter.is_active(button.id_for("On")) );
+    REQUIRE( !interpreter.is_active(button.id_for("Off")) );
+
+    interpreter.queue(toggle).queue(no_event).queue(toggle).execute();
+    REQUIRE( interpreter.is_active(button.id_for("On")) );
+}
+
+TEST_CASE( "Compile-time statechart tables", "[sismicpp]" ) {
+    using namespace sismicpp::compile_time;
+
+    REQUIRE( button.name == Name("My Button StateChart") );
+    REQUIRE( button.description == Name("A showcase of statecharts and buttons") );
+    REQUIRE( button.states[button.id_for("Button")].kind == sismicpp::StateKind::compound );
+    REQUIRE( button.states[button.id_for("Button")].initial == button.id_for("Off") );
+    REQUIRE( button.transitions[0].source == button.id_for("Off") );
+    REQUIRE( button.transitions[0].target == button.id_for("On") );
+
+    REQUIRE( alarm_clock.states[alarm_clock.id_for("running")].kind == sismicpp::StateKind::orthogonal );
+    REQUIRE( alarm_clock.states[alarm_clock.id_for("H")].kind == sismicpp::StateKind::deep_history );
+    REQUIRE( alarm_clock.states[alarm_clock.id_for("done")].kind == sismicpp::StateKind::final );
+    REQUIRE_THROWS_AS( unknown_target.validate(), sismicpp::statechart_error );
+}
+
+TEST_CASE( "Compile-time and dynamic interpreters agree", "[sismicpp]" ) {
+    using namespace sismicpp::compile_time;
+
+    int static_context = 0;
+    int dynamic_context = 0;
+    auto interpreter = make_interpreter(alarm_clock, &static_context);
+    sismicpp::Interpreter dynamic{make_dynamic_alarm_clock(), &dynamic_context};
+
+    auto same_configuration = [&] {
+        for (state_index id = 0; id < alarm_clock.state_count; ++id) {
+            std::string state_name(alarm_clock.states[id].name.data, alarm_clock.states[id].name.size);
+            if (interpreter.is_active(id) != dynamic.is_active(state_name)) {
+                return false;
+            }
+        }
+        return interpreter.is_in_final() == dynamic.is_in_final();
+    };
+
+    interpreter.execute();
+    dynamic.execute();
+    REQUIRE( same_configuration() );
+
+    Name events[] = {
+        "start", "arm", "start", "tick", "tick", "pause", "resume", "tick", "stop", "unknown",
+        "pause", "resume", "start", "tick", "pause", "off"
+    };
+    for (auto&& event : events) {
+        interpreter.queue(alarm_clock.event_for(event)).execute();
+        dynamic.queue(std::string(event.data, event.size)).execute();
+        REQUIRE( same_configuration() );
+        REQUIRE( static_context == dynamic_context );
+    }
+
+    REQUIRE( interpreter.is_in_final() );
+}
@@ -0,0 +1,405 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+
+#include <cassert>
+#include <cstdio>
+
+#include "model/compiled.h"
+
+static sismicpp::StateChart make_statechart() {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "0"), "");
+        statechart.add_state(CompoundState("0", "01"), "root");
+            statechart.add_state(OrthogonalState("01"), "0");
+                statechart.add_state(CompoundState("010", "0100"), "01");
+                    statechart.add_state(BasicState("0100"), "010");
+                    statechart.add_state(BasicState("0101"), "010");
+                statechart.add_state(BasicState("011"), "01");
+            statechart.add_state(ShallowHistoryState("0H", "01"), "0");
+        statechart.add_state(FinalState("00"), "root");
+    statechart.add_transition({
+        .source="0100",
+        .target="00",
+        .event="done"
+    });
+    statechart.add_transition({
+        .source="011",
+        .event="tick"
+    });
+
+    return statechart;
+}
+
+TEST_CASE( "Compiled states are numbered in pre-order", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    CompiledStateChart compiled{make_statechart()};
+
+    REQUIRE( compiled.size() == 9 );
+    REQUIRE( compiled.get_root() == 0 );
+    REQUIRE( compiled.name_for(0) == "root" );
+
+    std::vector<std::string> names;
+    for (state_id id = 0; id < compiled.size(); ++id) {
+        names.push_back(compiled.name_for(id));
+        REQUIRE( compiled.id_for(compiled.name_for(id)) == id );
+    }
+    REQUIRE( names == std::vector<std::string>{"root", "0", "01", "010", "0100", "0101", "011", "0H", "00"} );
+
+    REQUIRE( compiled.id_for("unknown") == no_state );
+    REQUIRE( compiled.parent_for(compiled.get_root()) == no_state );
+    REQUIRE( compiled.parent_for(compiled.id_for("0101")) == compiled.id_for("010") );
+
+    auto children = compiled.children_for(compiled.id_for("01"));
+    REQUIRE( children.size() == 2 );
+    REQUIRE( children[0] == compiled.id_for("010") );
+    REQUIRE( children[1] == compiled.id_for("011") );
+}
+
+TEST_CASE( "Compiled kinds, initial states and transitions", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    CompiledStateChart compiled{make_statechart()};
+
+    REQUIRE( compiled.kind_for(compiled.id_for("root")) == StateKind::compound );
+    REQUIRE( compiled.kind_for(compiled.id_for("01")) == StateKind::orthogonal );
+    REQUIRE( compiled.kind_for(compiled.id_for("0100")) == StateKind::basic );
+    REQUIRE( compiled.kind_for(compiled.id_for("0H")) == StateKind::shallow_history );
+    REQUIRE( compiled.kind_for(compiled.id_for("00")) == StateKind::final );
+
+    REQUIRE( compiled.initial_for(compiled.id_for("root")) == compiled.id_for("0") );
+    REQUIRE( compiled.initial_for(compiled.id_for("0H")) == compiled.id_for("01") );
+    REQUIRE( compiled.initial_for(compiled.id_for("0100")) == no_state );
+
+    auto& transitions = compiled.get_transitions();
+    REQUIRE( transitions.size() == 2 );
+    REQUIRE( transitions[0].source == compiled.id_for("0100") );
+    REQUIRE( transitions[0].target == compiled.id_for("00") );
+    REQUIRE( transitions[0].transition->event == "done" );
+    REQUIRE( transitions[1].is_internal() );
+
+    REQUIRE( compiled.depth_for(compiled.id_for("0100")) == 5 );
+    REQUIRE( compiled.least_common_ancestor(compiled.id_for("0100"), compiled.id_for("011")) == compiled.id_for("01") );
+    REQUIRE( compiled.least_common_ancestor(compiled.id_for("0100"), compiled.id_for("00")) == compiled.id_for("root") );
+    REQUIRE( compiled.least_common_ancestor(compiled.id_for("root"), compiled.id_for("00")) == no_state );
+}
+
+TEST_CASE( "Compiled kind flags and entry/exit functions", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto statechart = make_statechart();
+    statechart.add_state(DeepHistoryState("0D", "01"), "0");
+    statechart.state_for("011").on_entry = [] (void*, OnEntryExitContext&) {};
+    statechart.state_for("0100").on_exit = [] (void*, OnEntryExitContext&) {};
+    CompiledStateChart compiled{std::move(statechart)};
+
+    for (state_id id = 0; id < compiled.size(); ++id) {
+        auto& state = compiled.state_for(id);
+        REQUIRE( compiled.is_compound(id) == state.is_compound_state() );
+        REQUIRE( compiled.is_orthogonal(id) == state.is_orthogonal_state() );
+        REQUIRE( compiled.is_composite(id) == state.is_composite_state() );
+        REQUIRE( compiled.is_history(id) == state.is_history_state() );
+        REQUIRE( compiled.is_deep_history(id) == state.is_deep_history_state() );
+        REQUIRE( compiled.is_final(id) == state.is_final_state() );
+        REQUIRE( compiled.flags_for(id) == flags_for(compiled.kind_for(id)) );
+        REQUIRE( compiled.on_entry_for(id) == state.on_entry );
+        REQUIRE( compiled.on_exit_for(id) == state.on_exit );
+    }
+
+    REQUIRE( compiled.on_entry_for(compiled.id_for("011")) != nullptr );
+    REQUIRE( compiled.on_exit_for(compiled.id_for("0100")) != nullptr );
+    REQUIRE( (compiled.flags_for(compiled.id_for("0D")) & (kind_flag::history | kind_flag::deep_history)) ==
+             (kind_flag::history | kind_flag::deep_history) );
+    static_assert(flags_for(StateKind::basic) == 0, "basic states have no flags");
+}
+
+TEST_CASE( "Hierarchy index agrees with parent walks", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto statechart = make_statechart();
+    CompiledStateChart compiled{make_statechart()};
+
+    for (state_id id = 0; id < compiled.size(); ++id) {
+        auto& name = compiled.name_for(id);
+        REQUIRE( compiled.depth_for(id) == statechart.depth_for(name) );
+
+        auto ancestors = compiled.ancestors_for(id);
+        auto expected = statechart.ancestors_for(name);
+        REQUIRE( ancestors.size() == expected.size() );
+        for (size_t i = 0; i < expected.size(); ++i) {
+            REQUIRE( compiled.name_for(ancestors[i]) == expected[i] );
+            REQUIRE( compiled.ancestor_at_depth(id, compiled.depth_for(ancestors[i])) == ancestors[i] );
+        }
+        REQUIRE( compiled.ancestor_at_depth(id, compiled.depth_for(id)) == id );
+
+        for (state_id other = 0; other < compiled.size(); ++other) {
+            auto lca = compiled.least_common_ancestor(id, other);
+            auto expected_lca = statechart.least_common_ancestor(name, compiled.name_for(other));
+            REQUIRE( (lca == no_state ? std::string("") : compiled.name_for(lca)) == expected_lca );
+        }
+    }
+
+    REQUIRE( compiled.lowest_common_ancestor(compiled.id_for("0101"), compiled.id_for("010")) == compiled.id_for("010") );
+    REQUIRE( compiled.lowest_common_ancestor(compiled.id_for("0101"), compiled.id_for("0H")) == compiled.id_for("0") );
+}
+
+TEST_CASE( "Descendants are pre-order intervals", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto statechart = make_statechart();
+    CompiledStateChart compiled{make_statechart()};
+
+    for (state_id id = 0; id < compiled.size(); ++id) {
+        auto expected = statechart.descendants_for(compiled.name_for(id));
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<std::string> descendants;
+        for (auto&& descendant : compiled.descendants_for(id)) {
+            descendants.push_back(compiled.name_for(descendant));
+            REQUIRE( compiled.is_descendant(descendant, id) );
+            REQUIRE( !compiled.is_descendant(id, descendant) );
+        }
+        std::sort(descendants.begin(), descendants.end());
+
+        REQUIRE( descendants == expected );
+        REQUIRE( compiled.subtree_for(id).size() == expected.size() + 1 );
+    }
+
+    REQUIRE( !compiled.is_descendant(compiled.id_for("011"), compiled.id_for("010")) );
+    REQUIRE( statechart.descendants_for("01") == std::vector<std::string>{"010", "011", "0100", "0101"} );
+
+    auto leaves = statechart.leaf_for(std::vector<std::string>{"root", "0", "01", "0100", "011", "00"});
+    REQUIRE( leaves == std::vector<std::string>{"0100", "011", "00"} );
+}
+
+TEST_CASE( "Bitset iterates over set bits", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    Bitset bits{130};
+    REQUIRE( !bits.any() );
+
+    bits.set(0);
+    bits.set(63);
+    bits.set(64);
+    bits.set(129);
+    REQUIRE( bits.any() );
+    REQUIRE( bits.count() == 4 );
+    REQUIRE( bits.test(63) );
+    REQUIRE( !bits.test(62) );
+
+    std::vector<size_t> ones(bits.ones().begin(), bits.ones().end());
+    REQUIRE( ones == std::vector<size_t>{0, 63, 64, 129} );
+
+    auto range = bits.ones(1, 129);
+    REQUIRE( std::vector<size_t>(range.begin(), range.end()) == std::vector<size_t>{63, 64} );
+
+    bits.reset(64);
+    REQUIRE( bits.find_next(1, 130) == 63 );
+    REQUIRE( bits.find_next(64, 129) == 129 );
+
+    bits.clear();
+    REQUIRE( !bits.any() );
+}
+
+TEST_CASE( "Transitions are indexed by event in selection order", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto statechart = make_statechart();
+    statechart.add_transition({
+        .source="0",
+        .target="00",
+        .event="done"
+    });
+    statechart.add_transition({
+        .source="0101",
+        .target="0100",
+        .event="done",
+        .priority=1
+    });
+    statechart.add_transition({
+        .source="0101",
+        .target="011",
+        .event="done",
+        .priority=2
+    });
+    statechart.add_transition({
+        .source="011",
+        .target="00"
+    });
+    CompiledStateChart compiled{std::move(statechart)};
+
+    std::vector<transition_id> done;
+    auto candidates = compiled.transitions_for_event(compiled.symbol_for("done"));
+    done.assign(candidates.begin(), candidates.end());
+    REQUIRE( done == std::vector<transition_id>{0, 4, 3, 2} );
+
+    auto tick = compiled.transitions_for_event(compiled.symbol_for("tick"));
+    REQUIRE( tick.size() == 1 );
+    REQUIRE( tick[0] == 1 );
+
+    auto eventless = compiled.eventless_transitions();
+    REQUIRE( eventless.size() == 1 );
+    REQUIRE( eventless[0] == 5 );
+
+    REQUIRE( compiled.symbol_for("unknown") == no_symbol );
+    REQUIRE( compiled.transitions_for_event(no_symbol).empty() );
+}
+
+TEST_CASE( "Transitions and events are indexed by state", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto statechart = make_statechart();
+    statechart.add_transition({
+        .source="0101",
+        .target="0100",
+        .event="done"
+    });
+    statechart.add_transition({
+        .source="0101",
+        .target="011",
+        .event="done"
+    });
+    statechart.add_transition({
+        .source="011",
+        .target="00"
+    });
+    statechart.add_transition({
+        .source="0101",
+        .event="tick"
+    });
+
+    REQUIRE( statechart.events_for("0101") == std::vector<std::string>{"done", "tick"} );
+    REQUIRE( statechart.events_for(std::vector<std::string>{"011", "0101", "0100"}) == std::vector<std::string>{"done", "tick"} );
+    REQUIRE( statechart.events_for("") == statechart.events_for() );
+    REQUIRE( statechart.events_for("root").empty() );
+
+    CompiledStateChart compiled{std::move(statechart)};
+    auto ids = [] (Range<transition_id> range) {
+        return std::vector<transition_id>(range.begin(), range.end());
+    };
+
+    REQUIRE( ids(compiled.transitions_from(compiled.id_for("0101"))) == std::vector<transition_id>{2, 3, 5} );
+    REQUIRE( ids(compiled.transitions_from(compiled.id_for("011"))) == std::vector<transition_id>{1, 4} );
+    REQUIRE( compiled.transitions_from(compiled.id_for("root")).empty() );
+    REQUIRE( ids(compiled.transitions_to(compiled.id_for("00"))) == std::vector<transition_id>{0, 4} );
+    REQUIRE( ids(compiled.transitions_to(compiled.id_for("011"))) == std::vector<transition_id>{1, 3} );
+    REQUIRE( ids(compiled.transitions_to(compiled.id_for("0101"))) == std::vector<transition_id>{5} );
+
+    auto done = compiled.symbol_for("done");
+    auto tick = compiled.symbol_for("tick");
+    auto events = compiled.events_from(compiled.id_for("0101"));
+    REQUIRE( std::vector<symbol_id>(events.begin(), events.end()) == std::vector<symbol_id>{done, tick} );
+    REQUIRE( compiled.events_from(compiled.id_for("0")).empty() );
+
+    Bitset configuration(compiled.size());
+    configuration.set(compiled.id_for("0100"));
+    configuration.set(compiled.id_for("011"));
+    auto accepted = compiled.events_for(configuration.ones());
+    REQUIRE( accepted.count() == 2 );
+    REQUIRE( accepted.test(done) );
+    REQUIRE( accepted.test(tick) );
+
+    accepted.clear();
+    compiled.events_for(std::vector<state_id>{compiled.id_for("0101")}, accepted);
+    REQUIRE( accepted.count() == 2 );
+}
+
+TEST_CASE( "State and event names are interned", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    CompiledStateChart compiled{make_statechart()};
+    auto& symbols = compiled.get_symbols();
+
+    REQUIRE( symbols.size() == compiled.size() + 2 );
+    for (state_id id = 0; id < compiled.size(); ++id) {
+        REQUIRE( compiled.symbol_for(compiled.name_for(id)) == id );
+    }
+
+    auto done = compiled.symbol_for("done");
+    REQUIRE( done >= compiled.size() );
+    REQUIRE( symbols.name_for(done) == "done" );
+    REQUIRE( compiled.id_for("done") == no_state );
+    REQUIRE( compiled.get_transitions()[0].event == done );
+    REQUIRE( compiled.get_transitions()[1].event == compiled.symbol_for("tick") );
+
+    REQUIRE( compiled.symbol_for("unknown") == no_symbol );
+
+    SymbolTable table;
+    REQUIRE( table.intern("a") == 0 );
+    REQUIRE( table.intern("b") == 1 );
+    REQUIRE( table.intern("a") == 0 );
+    REQUIRE( table.find("c") == no_symbol );
+}
+
+TEST_CASE( "Transitions carry their exit root and entry path", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    auto statechart = make_statechart();
+    statechart.add_transition({
+        .source="0101",
+        .target="011",
+        .event="done"
+    });
+    statechart.add_transition({
+        .source="011",
+        .target="0101"
+    });
+    CompiledStateChart compiled{std::move(statechart)};
+
+    auto names = [&] (Range<state_id> ids) {
+        std::vector<std::string> ret;
+        for (auto&& id : ids) {
+            ret.push_back(compiled.name_for(id));
+        }
+        return ret;
+    };
+
+    auto& to_final = compiled.transition_for(0);
+    REQUIRE( compiled.name_for(to_final.exit_root) == "0" );
+    REQUIRE( names(to_final.entry_path) == std::vector<std::string>{"00"} );
+
+    auto& internal = compiled.transition_for(1);
+    REQUIRE( internal.exit_root == no_state );
+    REQUIRE( internal.entry_path.empty() );
+
+    auto& sibling = compiled.transition_for(2);
+    REQUIRE( compiled.name_for(sibling.exit_root) == "010" );
+    REQUIRE( names(sibling.entry_path) == std::vector<std::string>{"011"} );
+
+    auto& nested = compiled.transition_for(3);
+    REQUIRE( compiled.name_for(nested.exit_root) == "011" );
+    REQUIRE( names(nested.entry_path) == std::vector<std::string>{"010", "0101"} );
+}
+
+TEST_CASE( "Default-entry closures stop at history states", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    CompiledStateChart compiled{make_statechart()};
+
+    auto names = [&] (state_id id) {
+        std::vector<std::string> ret;
+        for (auto&& state : compiled.closure_for(id)) {
+            ret.push_back(compiled.name_for(state));
+        }
+        return ret;
+    };
+
+    REQUIRE( names(compiled.id_for("root")) == std::vector<std::string>{"0", "01", "010", "011", "0100"} );
+    REQUIRE( names(compiled.id_for("01")) == std::vector<std::string>{"010", "011", "0100"} );
+    REQUIRE( names(compiled.id_for("0100")).empty() );
+    REQUIRE( names(compiled.id_for("0H")).empty() );
+
+    auto statechart = make_statechart();
+    statechart.add_state(CompoundState("012", "012H"), "01");
+        statechart.add_state(DeepHistoryState("012H", "0120"), "012");
+        statechart.add_state(BasicState("0120"), "012");
+    CompiledStateChart with_history{std::move(statechart)};
+
+    std::vector<std::string> closure;
+    for (auto&& state : with_history.closure_for(with_history.id_for("01"))) {
+        closure.push_back(with_history.name_for(state));
+    }
+    REQUIRE( closure == std::vector<std::string>{"010", "011", "012", "0100", "012H"} );
+}
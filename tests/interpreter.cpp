@@ -2,7 +2,11 @@
 #include <catch2/catch.hpp>
 
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <mutex>
+#include <thread>
 
 #include "interpreter/default.h"
 
@@ -198,3 +202,713 @@ TEST_CASE( "Simple after", "[sismicpp]" ) {
     REQUIRE( !active("0") );
     REQUIRE( active("1") );
 }
+
+TEST_CASE( "Simple idle", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "0"), "");
+        statechart.add_state(BasicState("0"), "root");
+        statechart.add_state(BasicState("1"), "root");
+        statechart.add_transition({
+            .source="0",
+            .event="poke"
+        });
+        statechart.add_transition({
+            .source="0",
+            .event="check idle",
+            .guard=[] (auto, GuardContext& guard_context) { return guard_context.idle(1); },
+            .target="1"
+        });
+
+    Interpreter interp{std::move(statechart)};
+    auto& clock = (SimulatedClock&)(*interp.clock);
+    auto active = active_func(interp);
+
+    std::vector<MetaEventKind> kinds;
+    struct Listener : Attachable {
+        std::vector<MetaEventKind>& kinds;
+        explicit Listener(std::vector<MetaEventKind>& kinds) : kinds(kinds) {}
+        void operator()(std::shared_ptr<const MetaEvent> event) override {
+            kinds.push_back(event->kind);
+        }
+    } listener{kinds};
+    interp.attach(&listener);
+
+    interp.execute();
+    clock.set_time(0.5);
+    interp.queue("poke").execute();
+    REQUIRE( std::find(kinds.begin(), kinds.end(), MetaEventKind::transition_processed) != kinds.end() );
+    REQUIRE( std::find(kinds.begin(), kinds.end(), MetaEventKind::custom) == kinds.end() );
+
+    // The internal transition at 0.5 reset the idle time of state 0.
+    clock.set_time(1);
+    interp.queue("check idle").execute();
+    REQUIRE( active("0") );
+
+    clock.set_time(1.5);
+    interp.queue("check idle").execute();
+    REQUIRE( active("1") );
+}
+
+TEST_CASE( "Share a compiled statechart", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "0"), "");
+        statechart.add_state(BasicState("0"), "root");
+        statechart.add_state(BasicState("1"), "root");
+        statechart.add_transition({
+            .source="0",
+            .target="1",
+            .event="go!"
+        });
+
+    auto compiled = std::make_shared<const CompiledStateChart>(std::move(statechart));
+
+    Interpreter first{compiled, nullptr};
+    Interpreter second{compiled, nullptr};
+    first.execute();
+    second.execute();
+    first.queue("go!").execute();
+
+    REQUIRE( &first.get_statechart() == &second.get_statechart() );
+    REQUIRE( active_func(first)("1") );
+    REQUIRE( active_func(second)("0") );
+}
+
+TEST_CASE( "Query active states by id", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "0"), "");
+        statechart.add_state(OrthogonalState("0"), "root");
+            statechart.add_state(BasicState("00"), "0");
+            statechart.add_state(BasicState("01"), "0");
+        statechart.add_state(BasicState("1"), "root");
+        statechart.add_transition({
+            .source="00",
+            .target="1",
+            .event="go!",
+            .guard=[] (const void*, GuardContext& context) { return context.active("01"); }
+        });
+
+    Interpreter interp{std::move(statechart)};
+    interp.execute();
+
+    std::vector<std::string> active;
+    for (auto&& id : interp.get_active_states()) {
+        active.push_back(interp.get_statechart().name_for(static_cast<state_id>(id)));
+    }
+    REQUIRE( active == std::vector<std::string>{"root", "0", "00", "01"} );
+    REQUIRE( interp.is_active(interp.get_statechart().id_for("01")) );
+    REQUIRE( !interp.is_active("1") );
+    REQUIRE( !interp.is_active("unknown") );
+
+    interp.queue("go!").execute();
+
+    REQUIRE( interp.get_configuration() == std::vector<std::string>{"root", "1"} );
+    REQUIRE( interp.is_active("1") );
+    REQUIRE( !interp.is_active("0") );
+}
+
+TEST_CASE( "Stabilize with default-entry closures", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "0"), "");
+        statechart.add_state(CompoundState("0", "01"), "root");
+            statechart.add_state(OrthogonalState("01"), "0");
+                statechart.add_state(CompoundState("010", "0100"), "01");
+                    statechart.add_state(BasicState("0100"), "010");
+                statechart.add_state(CompoundState("011", "0110"), "01");
+                    statechart.add_state(BasicState("0110"), "011");
+        statechart.add_state(CompoundState("1", "1H"), "root");
+            statechart.add_state(ShallowHistoryState("1H", "10"), "1");
+            statechart.add_state(CompoundState("10", "100"), "1");
+                statechart.add_state(BasicState("100"), "10");
+        statechart.add_transition({
+            .source="0",
+            .target="1",
+            .event="go!"
+        });
+
+    Interpreter interp{std::move(statechart)};
+    auto macro_steps = interp.execute();
+
+    REQUIRE( macro_steps.size() == 1 );
+    auto& steps = macro_steps[0].steps;
+    REQUIRE( steps.size() == 2 );
+    REQUIRE( steps[0].entered_states == std::vector<std::string>{"root"} );
+    REQUIRE( steps[1].entered_states == std::vector<std::string>{"0", "01", "010", "011", "0100", "0110"} );
+
+    macro_steps = interp.queue("go!").execute();
+
+    REQUIRE( macro_steps.size() == 1 );
+    auto& history_steps = macro_steps[0].steps;
+    REQUIRE( history_steps.size() == 3 );
+    REQUIRE( history_steps[1].entered_states == std::vector<std::string>{"1H"} );
+    REQUIRE( history_steps[2].exited_states == std::vector<std::string>{"1H"} );
+    REQUIRE( history_steps[2].entered_states == std::vector<std::string>{"10", "100"} );
+}
+
+TEST_CASE( "Share a macro step cache", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "0"), "");
+        statechart.add_state(BasicState("0"), "root");
+        statechart.add_state(BasicState("1"), "root");
+        statechart.add_transition({
+            .source="0",
+            .target="1",
+            .event="go!"
+        });
+        statechart.add_transition({
+            .source="1",
+            .target="0",
+            .event="back!",
+            .guard=[] (const void* context, GuardContext&) { return ++*(int*)context > 0; }
+        });
+
+    auto compiled = std::make_shared<const CompiledStateChart>(std::move(statechart));
+    auto cache = std::make_shared<MacroStepCache>(compiled, 2);
+
+    int evaluations = 0;
+    Interpreter first{compiled, &evaluations};
+    Interpreter second{compiled, &evaluations};
+    first.set_cache(cache);
+    second.set_cache(cache);
+    first.execute();
+    second.execute();
+
+    auto misses = cache->get_misses();
+    first.queue("go!").execute();
+    REQUIRE( cache->get_misses() > misses );
+
+    auto hits = cache->get_hits();
+    auto macro_steps = second.queue("go!").execute();
+    REQUIRE( cache->get_hits() > hits );
+    REQUIRE( macro_steps.size() == 1 );
+    REQUIRE( macro_steps[0].steps[0].event->name == "go!" );
+    REQUIRE( macro_steps[0].steps[0].exited_states == std::vector<std::string>{"0"} );
+    REQUIRE( macro_steps[0].steps[0].entered_states == std::vector<std::string>{"1"} );
+    REQUIRE( active_func(second)("1") );
+
+    // Selections that evaluate a guard are never cached.
+    first.queue("back!").execute();
+    second.queue("back!").execute();
+    REQUIRE( evaluations == 2 );
+    REQUIRE( active_func(second)("0") );
+    REQUIRE( cache->size() <= cache->get_capacity() );
+
+    StateChart other_statechart{"OtherStateChart"};
+    other_statechart.add_state(CompoundState("root", "0"), "");
+        other_statechart.add_state(BasicState("0"), "root");
+
+    Interpreter other{std::move(other_statechart)};
+    REQUIRE_THROWS_AS( other.set_cache(cache), sismic_error );
+}
+
+TEST_CASE( "Events sent by an evaluator must be internal or meta-events", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    struct PlainEventEvaluator : CppEvaluator {
+        using CppEvaluator::CppEvaluator;
+
+        void execute_action_into(const Transition&, std::shared_ptr<const Event>,
+                                 std::vector<std::shared_ptr<const Event>>& sent_events) const override {
+            sent_events.push_back(std::make_shared<const Event>("plain"));
+        }
+    };
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "0"), "");
+        statechart.add_state(BasicState("0"), "root");
+        statechart.add_state(BasicState("1"), "root");
+        statechart.add_transition({
+            .source="0",
+            .target="1",
+            .event="go!",
+            .action=[] (auto, ActionContext&) {}
+        });
+
+    Interpreter interp{std::move(statechart)};
+    interp.set_evaluator(std::make_unique<PlainEventEvaluator>(interp, interp, nullptr, &interp.get_event_pool()));
+
+    std::vector<std::shared_ptr<const MetaEvent>> received;
+    struct Listener : Attachable {
+        std::vector<std::shared_ptr<const MetaEvent>>& received;
+        explicit Listener(std::vector<std::shared_ptr<const MetaEvent>>& received) : received(received) {}
+        void operator()(std::shared_ptr<const MetaEvent> event) override {
+            received.push_back(std::move(event));
+        }
+    } listener{received};
+    interp.attach(&listener);
+
+    interp.execute();
+    REQUIRE_THROWS_AS( interp.queue("go!").execute(), sismic_error );
+    for (auto&& event : received) {
+        REQUIRE( event->is_meta_event() );
+    }
+    interp.detach(&listener);
+}
+
+TEST_CASE( "Delayed events are consumed by time, then in queue order", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "0"), "");
+        statechart.add_state(BasicState("0"), "root");
+
+    Interpreter interp{std::move(statechart)};
+    interp.execute();
+
+    auto delayed = [] (std::string name, double delay) {
+        auto event = std::make_shared<Event>(std::move(name));
+        event->delay = delay;
+        return event;
+    };
+
+    interp.queue(delayed("c", 2)).queue(delayed("a", 1)).queue("now").queue(delayed("d", 2));
+    interp.queue(delayed("b", 1)).queue("later").queue(delayed("e", 3));
+
+    auto consumed = [&interp] {
+        std::vector<std::string> ret;
+        for (auto&& macro_step : interp.execute()) {
+            ret.push_back(macro_step.steps.front().event->name);
+        }
+        return ret;
+    };
+
+    REQUIRE( consumed() == std::vector<std::string>{"now", "later"} );
+
+    static_cast<SimulatedClock&>(*interp.clock).set_time(2);
+    interp.queue("two");
+    REQUIRE( consumed() == std::vector<std::string>{"a", "b", "c", "d", "two"} );
+
+    static_cast<SimulatedClock&>(*interp.clock).set_time(5);
+    REQUIRE( consumed() == std::vector<std::string>{"e"} );
+    REQUIRE( consumed().empty() );
+}
+
+TEST_CASE( "Event queue keeps time and insertion order", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    EventQueue queue;
+    std::vector<std::pair<double, symbol_id>> expected;
+    for (symbol_id i = 0; i < 1000; ++i) {
+        // Mostly increasing times, with some going back to exercise the heap, and some beyond the wheel.
+        auto time = static_cast<double>(i % 7 == 0 ? (i * 37) % 100 : i / 10);
+        if (i % 101 == 0) {
+            time = 1e6 + (i % 3);
+        }
+        queue.push({.time=time, .symbol=i, .event=nullptr});
+        expected.push_back({time, i});
+    }
+    std::stable_sort(expected.begin(), expected.end(), [] (auto& first, auto& second) {
+        return first.first < second.first;
+    });
+
+    REQUIRE( queue.size() == 1000 );
+    queue.advance(1e7);
+    for (auto&& pair : expected) {
+        REQUIRE( queue.front().symbol == pair.second );
+        auto queued = queue.pop();
+        REQUIRE( queued.time == pair.first );
+        REQUIRE( queued.symbol == pair.second );
+    }
+    REQUIRE( queue.empty() );
+}
+
+TEST_CASE( "Cancel queued and sent events", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "idle"), "");
+        statechart.add_state(BasicState("idle"), "root");
+        statechart.add_state(BasicState("waiting"), "root");
+        statechart.add_state(BasicState("replied"), "root");
+        statechart.add_state(BasicState("timed out"), "root");
+        statechart.add_transition({
+            .source="idle",
+            .event="request",
+            .target="waiting",
+            .action=[] (auto context, ActionContext& action_context) {
+                Event timeout("timeout");
+                timeout.delay = 5;
+                *static_cast<EventHandle*>(context) = action_context.send(std::move(timeout));
+            }
+        });
+        statechart.add_transition({
+            .source="waiting",
+            .event="reply",
+            .target="replied",
+            .action=[] (auto context, ActionContext&) { static_cast<EventHandle*>(context)->cancel(); }
+        });
+        statechart.add_transition({
+            .source="waiting",
+            .event="timeout",
+            .target="timed out"
+        });
+
+    EventHandle timeout;
+    Interpreter interp{std::move(statechart), &timeout};
+    auto& clock = static_cast<SimulatedClock&>(*interp.clock);
+    auto active = active_func(interp);
+
+    interp.execute();
+    interp.queue("request").execute();
+    REQUIRE( timeout.valid() );
+    REQUIRE( active("waiting") );
+
+    clock.set_time(1);
+    interp.queue("reply").execute();
+    REQUIRE( timeout.is_cancelled() );
+
+    clock.set_time(10);
+    REQUIRE( interp.execute().empty() );
+    REQUIRE( active("replied") );
+
+    auto cancelled = interp.schedule("unknown");
+    auto kept = interp.schedule("other");
+    auto delayed = std::make_shared<Event>("far");
+    delayed->delay = 1e6;
+    auto far = interp.schedule(delayed);
+    cancelled.cancel();
+    far.cancel();
+
+    auto macro_steps = interp.execute();
+    REQUIRE( macro_steps.size() == 1 );
+    REQUIRE( macro_steps[0].steps[0].event->name == "other" );
+    REQUIRE( !kept.is_cancelled() );
+
+    clock.set_time(2e6);
+    REQUIRE( interp.execute().empty() );
+}
+
+TEST_CASE( "Queue and execute a batch of events", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    struct LateEvent : Attachable {
+        Interpreter* interp = nullptr;
+
+        void operator()(std::shared_ptr<const MetaEvent> event) override {
+            if (event->name == "event consumed" and event->event->name == "b") {
+                interp->queue("late");
+            }
+        }
+    };
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "0"), "");
+        statechart.add_state(BasicState("0"), "root");
+        statechart.add_state(BasicState("1"), "root");
+        statechart.add_transition({
+            .source="0",
+            .event="a",
+            .target="1",
+            .action=[] (auto context, ActionContext& action_context) {
+                action_context.send("internal");
+                *static_cast<void**>(context) = action_context.get_event()->data;
+            }
+        });
+        statechart.add_transition({
+            .source="1",
+            .event="b",
+            .target="0"
+        });
+
+    void* data = nullptr;
+    Interpreter interp{std::move(statechart), &data};
+    LateEvent late;
+    late.interp = &interp;
+    interp.attach(&late);
+    interp.execute();
+
+    int payload = 0;
+    interp.queue("before");
+    auto result = interp.execute_batch(std::vector<std::pair<std::string, void*>>{{"a", &payload}, {"unknown", nullptr}, {"b", nullptr}});
+
+    std::vector<std::string> consumed;
+    for (auto&& macro_step : result.macro_steps) {
+        consumed.push_back(macro_step.steps.front().event->name);
+    }
+    REQUIRE( consumed == std::vector<std::string>{"before", "a", "internal", "unknown", "b"} );
+    REQUIRE( result.consumed_events == 5 );
+    REQUIRE( result.processed_transitions == 2 );
+    REQUIRE( result.sent_events == 1 );
+    REQUIRE( data == &payload );
+    REQUIRE( active_func(interp)("0") );
+
+    auto macro_steps = interp.execute();
+    REQUIRE( macro_steps.size() == 1 );
+    REQUIRE( macro_steps[0].steps.front().event->name == "late" );
+
+    auto a = std::make_shared<Event>("a");
+    auto b = std::make_shared<Event>("b");
+    b->delay = 1;
+    interp.queue_many(std::vector<std::shared_ptr<Event>>{a, b});
+    REQUIRE( interp.execute().size() == 2 );
+    static_cast<SimulatedClock&>(*interp.clock).set_time(1);
+    REQUIRE( interp.execute_batch(std::vector<std::string>{}).consumed_events == 0 );
+    REQUIRE( interp.execute_batch(std::vector<std::string>{"a"}).consumed_events == 3 );
+}
+
+TEST_CASE( "Events are allocated from a pool", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "ping"), "");
+        statechart.add_state(BasicState("ping"), "root");
+        statechart.add_state(BasicState("pong"), "root");
+        statechart.add_transition({
+            .source="ping",
+            .event="hit",
+            .target="pong",
+            .action=[] (auto, ActionContext& action_context) { action_context.send(Event("hit")); }
+        });
+        statechart.add_transition({
+            .source="pong",
+            .event="hit",
+            .target="ping"
+        });
+
+    Interpreter interp{std::move(statechart)};
+    auto& pool = interp.get_event_pool();
+    interp.execute();
+
+    auto macro_steps = interp.queue("hit").execute();
+    REQUIRE( macro_steps.size() == 2 );
+    auto& sent = macro_steps[0].steps[0].sent_events;
+    REQUIRE( sent.size() == 1 );
+    REQUIRE( sent[0]->get_kind() == EventKind::internal );
+    REQUIRE( macro_steps[0].steps[0].event->get_kind() == EventKind::external );
+    REQUIRE( MetaEvent("step started", 0).is_meta_event() );
+
+    // Copies into an Event do not keep the kind of the derived event.
+    Event copy = static_cast<const Event&>(*sent[0]);
+    REQUIRE( copy.get_kind() == EventKind::external );
+
+    auto stats = pool.get_stats();
+    REQUIRE( stats.in_use > 0 );
+    REQUIRE( stats.high_water >= stats.in_use );
+    REQUIRE( stats.capacity >= stats.high_water );
+
+    // Released events go back to the pool, which stops growing once it holds a step worth of events.
+    macro_steps.clear();
+    auto in_use = pool.get_stats().in_use;
+    for (int i = 0; i < 10; ++i) {
+        interp.queue("hit").execute();
+    }
+    pool.reset_high_water();
+    auto warm = pool.get_stats();
+    REQUIRE( warm.in_use == in_use );
+    REQUIRE( warm.high_water == in_use );
+
+    for (int i = 0; i < 1000; ++i) {
+        interp.queue("hit").execute();
+    }
+    auto steady = pool.get_stats();
+    REQUIRE( steady.in_use == in_use );
+    REQUIRE( steady.capacity == warm.capacity );
+    REQUIRE( steady.slabs == warm.slabs );
+    REQUIRE( steady.high_water < steady.capacity );
+
+    // Events may outlive the pool owner.
+    auto other_pool = EventPool::create();
+    auto event = make_pooled<const Event>(other_pool.get(), "hit");
+    auto handle = EventHandle::create(other_pool.get());
+    REQUIRE( other_pool->get_stats().in_use == 2 );
+    other_pool.reset();
+    handle.cancel();
+    REQUIRE( handle.is_cancelled() );
+    REQUIRE( event->name == "hit" );
+}
+
+TEST_CASE( "Listeners subscribe to meta-event kinds", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "0"), "");
+        statechart.add_state(BasicState("0"), "root");
+        statechart.add_state(BasicState("1"), "root");
+        statechart.add_transition({
+            .source="0",
+            .event="toggle",
+            .target="1"
+        });
+        statechart.add_transition({
+            .source="1",
+            .event="toggle",
+            .target="0"
+        });
+
+    struct Listener : Attachable {
+        MetaEventMask subscriptions;
+        std::vector<std::string> entries = {};
+        explicit Listener(MetaEventMask subscriptions) : subscriptions(subscriptions) {}
+        MetaEventMask get_subscriptions() const override {
+            return subscriptions;
+        }
+        void operator()(std::shared_ptr<const MetaEvent> event) override {
+            entries.push_back(event->name + " " + event->get_state());
+        }
+    };
+
+    Interpreter interp{std::move(statechart)};
+    auto& pool = interp.get_event_pool();
+    Listener entered{mask_for(MetaEventKind::state_entered)};
+    Listener all{all_meta_events};
+    interp.attach(&entered);
+    interp.attach(&all);
+    interp.execute();
+    interp.queue("toggle").execute();
+
+    REQUIRE( entered.entries == std::vector<std::string>({"state entered root", "state entered 0", "state entered 1"}) );
+    REQUIRE( all.entries.size() > entered.entries.size() );
+
+    // Without listeners nor code in the statechart, only the queued event is allocated.
+    interp.detach(&all);
+    interp.detach(&entered);
+    pool.reset_high_water();
+    interp.queue("toggle").execute();
+    REQUIRE( pool.get_stats().high_water == pool.get_stats().in_use + 1 );
+    REQUIRE( entered.entries.size() == 3 );
+
+    interp.attach(&entered);
+    interp.queue("toggle").execute();
+    REQUIRE( entered.entries.back() == "state entered 1" );
+}
+
+TEST_CASE( "Bound the macro steps of an execution", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "a"), "");
+        statechart.add_state(BasicState("a"), "root");
+        statechart.add_state(BasicState("b"), "root");
+        statechart.add_state(BasicState("c"), "root");
+        statechart.add_transition({
+            .source="a",
+            .event="go",
+            .target="b",
+            .action=[] (auto, ActionContext& action_context) { action_context.send(Event("next")); }
+        });
+        statechart.add_transition({
+            .source="b",
+            .event="next",
+            .target="c",
+            .action=[] (auto, ActionContext& action_context) { action_context.send(Event("next")); }
+        });
+        statechart.add_transition({
+            .source="c",
+            .event="next",
+            .target="a"
+        });
+
+    Interpreter interp{std::move(statechart)};
+    auto& clock = (SimulatedClock&)(*interp.clock);
+    auto active = active_func(interp);
+    interp.execute();
+
+    interp.queue("go");
+    auto report = interp.execute_for(2);
+    REQUIRE( report.macro_steps == 2 );
+    REQUIRE( report.interrupted );
+    REQUIRE( report.queued_events == 1 );
+    REQUIRE( report.has_due_events );
+    REQUIRE( active("c") );
+
+    report = interp.execute_for(10);
+    REQUIRE( report.macro_steps == 1 );
+    REQUIRE( !report.interrupted );
+    REQUIRE( report.queued_events == 0 );
+    REQUIRE( !report.has_due_events );
+    REQUIRE( active("a") );
+
+    Event delayed{"go"};
+    delayed.delay = 5;
+    interp.queue(std::make_shared<Event>(delayed));
+    report = interp.execute_for(10);
+    REQUIRE( report.macro_steps == 0 );
+    REQUIRE( !report.interrupted );
+    REQUIRE( report.queued_events == 1 );
+    REQUIRE( !report.has_due_events );
+
+    clock.set_time(5);
+    report = interp.execute_until(std::chrono::steady_clock::now());
+    REQUIRE( report.macro_steps == 0 );
+    REQUIRE( report.interrupted );
+    REQUIRE( report.has_due_events );
+
+    size_t transitions = 0;
+    report = interp.execute_until(std::chrono::steady_clock::now() + std::chrono::hours(1), [&] (const MicroStepView& step) {
+        transitions += step.transition ? 1 : 0;
+    });
+    REQUIRE( report.macro_steps == 3 );
+    REQUIRE( !report.interrupted );
+    REQUIRE( transitions == 3 );
+    REQUIRE( active("a") );
+}
+
+TEST_CASE( "Run until stopped, sleeping until events are due", "[sismicpp]" ) {
+    using namespace sismicpp;
+
+    StateChart statechart{"MyStateChart"};
+    statechart.add_state(CompoundState("root", "a"), "");
+        statechart.add_state(BasicState("a"), "root");
+        statechart.add_state(BasicState("b"), "root");
+        statechart.add_transition({
+            .source="a",
+            .event="ping",
+            .target="b",
+            .action=[] (auto, ActionContext& action_context) {
+                Event pong{"pong"};
+                pong.delay = 0.05;
+                action_context.send(pong);
+            }
+        });
+        statechart.add_transition({
+            .source="b",
+            .event="pong",
+            .target="a"
+        });
+
+    Interpreter interp{std::move(statechart)};
+    interp.clock = std::make_unique<SteadyClock>();
+
+    std::mutex mutex;
+    std::condition_variable entered;
+    std::vector<std::pair<std::string, double>> entries;
+    std::thread runner([&] {
+        interp.run([&] (const MicroStepView& step) {
+            if (step.transition) {
+                std::lock_guard<std::mutex> lock(mutex);
+                entries.emplace_back(interp.get_statechart().name_for(step.entered_states[0]), step.time);
+                entered.notify_one();
+            }
+        });
+    });
+
+    interp.post("ping");
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        REQUIRE( entered.wait_for(lock, std::chrono::seconds(5), [&] { return entries.size() == 2; }) );
+    }
+    interp.stop();
+    runner.join();
+
+    REQUIRE( entries[0].first == "b" );
+    REQUIRE( entries[1].first == "a" );
+    REQUIRE( entries[1].second - entries[0].second >= 0.05 );
+    REQUIRE( interp.is_active("a") );
+
+    // A stop requested before run() makes it return right away, with the posted events queued.
+    interp.post("ping");
+    interp.stop();
+    interp.run();
+    REQUIRE( interp.is_active("a") );
+    interp.execute();
+    REQUIRE( interp.is_active("b") );
+}